@@ -1,15 +1,38 @@
 // Copyright 2019 Chris Solinas
 #include "Go.h"
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <cassert>
+#include <utility>
+
+// room for a game as long as the solver searches, reserved up front
+static void reserve(std::stack<Board, std::vector<Board>> *boards,
+    std::stack<int, std::vector<int>> *passes, std::vector<long> *hist) {
+  std::vector<Board> board_room;
+  board_room.reserve(MAX_DEPTH + 1);
+  *boards = std::stack<Board, std::vector<Board>>(std::move(board_room));
+  std::vector<int> pass_room;
+  pass_room.reserve(MAX_DEPTH + 1);
+  *passes = std::stack<int, std::vector<int>>(std::move(pass_room));
+  hist->reserve(MAX_DEPTH + 1);
+}
 
-Go::Go(int _n) : to_move(BLACK), n(_n) {
-  Board::init_zobrist();
+Go::Go(int _n) : to_move(BLACK), n(_n), superko_rejected(false) {
+  reserve(&boards, &passes, &superko_hist);
   boards.push(Board(_n));
   passes.push(0);
 }
 
+Go::Go(const Board& board, int _passes) : to_move(BLACK), n(board.n),
+  superko_rejected(false) {
+  reserve(&boards, &passes, &superko_hist);
+  boards.push(board);
+  passes.push(_passes);
+  if (board.stones[BLACK] | board.stones[WHITE]) add_history(board.h);
+}
+
 Go::~Go() {}
 
 int Go::size() { return n; }
@@ -20,9 +43,29 @@ bool Go::game_over() {
 
 bool Go::last_move_was_pass() { return passes.top() > 0; }
 
+int Go::get_passes() { return passes.top(); }
+
+const std::vector<long>& Go::get_history() { return superko_hist; }
+
+bool Go::repeats(long hash) {
+  return std::binary_search(superko_hist.begin(), superko_hist.end(), hash);
+}
+
+void Go::add_history(long hash) {
+  auto it = std::lower_bound(superko_hist.begin(), superko_hist.end(), hash);
+  if (it == superko_hist.end() || *it != hash) superko_hist.insert(it, hash);
+}
+
+bool Go::rejected_by_superko() { return superko_rejected; }
+
+Color Go::to_play() { return static_cast<Color>(to_move); }
+
+void Go::set_to_play(Color c) { to_move = c; }
+
 bool Go::make_move(int point_ind, Color color) {
   // first copy
   boards.push(boards.top());
+  superko_rejected = false;
 
   // check for a pass
   if (point_ind == PASS_IND) {
@@ -38,11 +81,14 @@ bool Go::make_move(int point_ind, Color color) {
     boards.pop();
   } else {
     // move succeeded, check superko
-    if (superko_hist.find(boards.top().h) != superko_hist.end()) {
+    long h = boards.top().h;
+    auto it = std::lower_bound(superko_hist.begin(), superko_hist.end(), h);
+    if (it != superko_hist.end() && *it == h) {
       res = false;
+      superko_rejected = true;
       boards.pop();
     } else {
-      superko_hist.insert(boards.top().h);
+      superko_hist.insert(it, h);
     }
   }
 
@@ -65,7 +111,11 @@ bool Go::undo_move() {
   int last_passes = passes.top();
   passes.pop();
   // don't erase superko hist if popping a pass
-  if (last_passes <= passes.top())  superko_hist.erase(old.h);
+  if (last_passes <= passes.top()) {
+    auto it = std::lower_bound(superko_hist.begin(), superko_hist.end(),
+        old.h);
+    if (it != superko_hist.end() && *it == old.h) superko_hist.erase(it);
+  }
   boards.pop();
   switch_to_move();
   return true;
@@ -89,20 +139,18 @@ void Go::switch_to_move() {
  * nullptr is a valid parameter value for moves if we just care to test
  * that there are moves available
  **/
-long Go::get_moves(std::vector<int> *moves) {
-  if (moves != nullptr)  moves->clear();
-  std::bitset<64> legal(boards.top().empty_points());
-  for (int i = 0; i < n*n; i++) {
-    if (legal.test(i)) {
-      if (moves != nullptr)
-        moves->push_back(i);
+Bitboard Go::get_moves(std::vector<int> *moves) {
+  Bitboard legal = boards.top().empty_points();
+  if (moves != nullptr) {
+    moves->clear();
+    for (Bitboard rest = legal; rest; rest &= rest - 1) {
+      moves->push_back(lowest_point(rest));
     }
+    // include pass move
+    moves->push_back(PASS_IND);
   }
 
-  // include pass move
-  if (moves != nullptr) moves->push_back(PASS_IND);
-
-  return legal.to_ulong();
+  return legal;
 }
 
 bool Go::fills_eye(int point_ind, Color c) {
@@ -113,3 +161,41 @@ bool Go::fills_eye(int point_ind, Color c) {
 Board& Go::get_board() { return boards.top(); }
 
 Color Go::opponent(Color c) { return Board::opponent(c); }
+
+bool Go::parse_point(const std::string& coord, int n, int *point_ind) {
+  if (coord == "pass") {
+    *point_ind = PASS_IND;
+    return true;
+  }
+  if (coord.size() < 2 || coord.size() > 3) return false;
+  if (coord[1] < '1' || coord[1] > '9') return false;
+  int row = coord[0] - 'a';
+  int col = coord[1] - '1';
+  if (coord.size() == 3) {
+    if (coord[2] < '0' || coord[2] > '9') return false;
+    col = 10 * (col + 1) + coord[2] - '0' - 1;
+  }
+  if (row < 0 || row >= n || col < 0 || col >= n) return false;
+  *point_ind = row * n + col;
+  return true;
+}
+
+bool Go::parse_vertex(const std::string& vertex, int n, int *point_ind) {
+  std::string v(vertex);
+  for (char& ch : v) ch = std::tolower(ch);
+  if (v == "pass") {
+    *point_ind = PASS_IND;
+    return true;
+  }
+  if (v.size() < 2 || v.size() > 3 || v[1] < '1' || v[1] > '9') return false;
+  if (v[0] < 'a' || v[0] > 'z' || v[0] == 'i') return false;
+  int col = v[0] - 'a' - (v[0] > 'i');
+  int number = v[1] - '0';
+  if (v.size() == 3) {
+    if (v[2] < '0' || v[2] > '9') return false;
+    number = 10 * number + v[2] - '0';
+  }
+  if (col >= n || number > n) return false;
+  *point_ind = (n - number) * n + col;
+  return true;
+}
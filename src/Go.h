@@ -1,7 +1,7 @@
 // Copyright 2019 Chris Solinas
 #pragma once
 #include <stack>
-#include <set>
+#include <string>
 #include <vector>
 
 #include "board.h"
@@ -10,7 +10,7 @@
 /*
  * Play games of Go using a fast bitboard implementation
  *
- * Uses the least significant bits for boards smaller than 8x8.
+ * Uses the least significant bits for boards smaller than the Bitboard.
  * The bottom right corner of the board is always the least significant
  * digit
 
@@ -21,28 +21,51 @@ constexpr int MAX_VAL = 100000;
 constexpr int MAX_DEPTH = 180;
 
 class Go {
-  std::stack<Board> boards;
-  std::set<long> superko_hist;
+  // vectors keep their memory when moves are undone, so a search that has
+  // been as deep before doesn't allocate
+  std::stack<Board, std::vector<Board>> boards;
+  std::vector<long> superko_hist;  // sorted
   int to_move;
   int n;
-  std::stack<int> passes;
+  std::stack<int, std::vector<int>> passes;
+  bool superko_rejected;
 
   void switch_to_move();
 
  public:
   Go(int n);
+  // start from a position reached by earlier moves, it can't be repeated.
+  // passes is the number of passes that led to it
+  explicit Go(const Board& board, int passes = 0);
   ~Go();
 
   bool make_move(int point_ind, Color color);
   bool undo_move();
   float score(Color color);
-  long get_moves(std::vector<int> *moves);
+  Bitboard get_moves(std::vector<int> *moves);
   void print_board();
   int size();
   bool game_over();
   bool fills_eye(int point_ind, Color c);
   bool last_move_was_pass();
+  int get_passes();
+  // hashes of every position that can't be repeated, in ascending order
+  const std::vector<long>& get_history();
+  // true if the position with this hash can't be repeated
+  bool repeats(long hash);
+  // forbid repeating a position from before the start of this game
+  void add_history(long hash);
+  // the color expected to move next
+  Color to_play();
+  void set_to_play(Color c);
+  // true if the last failed make_move only failed on positional superko
+  bool rejected_by_superko();
   static Color opponent(Color c);
+  // read a point such as "c2" or "pass", false if it isn't on the board
+  static bool parse_point(const std::string& coord, int n, int *point_ind);
+  // read a GTP vertex such as "C3" or "pass" in either case: a column letter
+  // that skips 'i', then the row counted from the bottom
+  static bool parse_vertex(const std::string& vertex, int n, int *point_ind);
   Board& get_board();
 };
 
@@ -0,0 +1,21 @@
+// Copyright 2019 Chris Solinas
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+static thread_local long allocations = 0;
+
+long thread_allocations() { return allocations; }
+
+void* operator new(std::size_t size) {
+  allocations++;
+  // malloc(0) may return nullptr, new must not
+  void *p = std::malloc(size > 0 ? size : 1);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,14 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+/*
+ * Count of heap allocations
+ *
+ * allocations.cc replaces the global operator new with one that counts each
+ * call per thread before handing it to malloc, so a caller can check how much
+ * a piece of code allocates, e.g. that a search allocates nothing once its
+ * buffers have grown.
+ * */
+
+// allocations made by the calling thread since it started
+long thread_allocations();
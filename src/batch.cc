@@ -0,0 +1,348 @@
+// Copyright 2019 Chris Solinas
+#include "batch.h"
+
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "allocations.h"
+#include "solver.h"
+
+bool BatchPosition::setup(Go *game) const {
+  if (history.empty()) {
+    *game = Go(board, passes);
+    for (long hash : superko) game->add_history(hash);
+    return true;
+  }
+
+  *game = Go(n);
+  for (auto& move : history) {
+    if (!game->make_move(move.second, move.first)) return false;
+  }
+  const Board& b = game->get_board();
+  return b.stones[BLACK] == board.stones[BLACK] &&
+    b.stones[WHITE] == board.stones[WHITE];
+}
+
+bool parse_batch_position(const std::string& text, BatchPosition *p) {
+  std::stringstream is(text);
+  std::string rows, side, token;
+  if (!(is >> p->n >> rows >> side)) {
+    p->error = "expected <size> <board> <b|w>";
+    return false;
+  }
+  if (p->n < 2 || p->n > MAX_BOARD_SIZE) {
+    p->error = "board size must be between 2 and " +
+      std::to_string(MAX_BOARD_SIZE);
+    return false;
+  }
+  if (!Board::from_string(rows, p->n, &p->board)) {
+    p->error = "bad board " + rows;
+    return false;
+  }
+  if (side != "b" && side != "w") {
+    p->error = "side to move must be b or w";
+    return false;
+  }
+  p->to_move = side == "b" ? BLACK : WHITE;
+
+  while (is >> token) {
+    int point;
+    if (token.size() < 3 || (token[0] != 'b' && token[0] != 'w') ||
+        token[1] != ':' || !Go::parse_point(token.substr(2), p->n, &point)) {
+      p->error = "bad history move " + token;
+      return false;
+    }
+    p->history.push_back(std::make_pair(token[0] == 'b' ? BLACK : WHITE,
+          point));
+  }
+  return true;
+}
+
+bool parse_gtp_script(std::istream& in, BatchPosition *p) {
+  p->n = 3;
+  p->to_move = BLACK;
+  std::string text, command, color, point;
+  int line = 0;
+  while (std::getline(in, text)) {
+    line++;
+    std::stringstream is(text.substr(0, text.find('#')));
+    if (!(is >> command)) continue;
+    if (command == "boardsize") {
+      if (!(is >> p->n) || p->n < 2 || p->n > MAX_BOARD_SIZE ||
+          !p->history.empty()) {
+        p->error = "bad boardsize on line " + std::to_string(line);
+        return false;
+      }
+    } else if (command == "play" || command == "genmove") {
+      if (!(is >> color) || (color != "b" && color != "w")) {
+        p->error = "bad color on line " + std::to_string(line);
+        return false;
+      }
+      p->to_move = color == "b" ? BLACK : WHITE;
+      if (command == "genmove") break;
+      int move;
+      if (!(is >> point) || !Go::parse_point(point, p->n, &move)) {
+        p->error = "bad move on line " + std::to_string(line);
+        return false;
+      }
+      p->history.push_back(std::make_pair(p->to_move, move));
+      p->to_move = Go::opponent(p->to_move);
+    }
+  }
+
+  // the board is wherever the moves lead
+  Go game(p->n);
+  for (auto& move : p->history) {
+    if (!game.make_move(move.second, move.first)) {
+      p->error = "illegal move in script";
+      return false;
+    }
+  }
+  p->board = game.get_board();
+  return true;
+}
+
+// read one "[value]" of an SGF property, undoing escapes
+static bool read_sgf_value(const std::string& s, size_t *i,
+    std::string *value) {
+  value->clear();
+  for ((*i)++; *i < s.size() && s[*i] != ']'; (*i)++) {
+    if (s[*i] == '\\' && *i + 1 < s.size()) (*i)++;
+    value->push_back(s[*i]);
+  }
+  if (*i == s.size()) return false;
+  (*i)++;
+  return true;
+}
+
+// the points of an SGF point or "xy:xy" rectangle, false if any is off the
+// board. An empty value is a pass, as is "tt" on boards up to 19x19.
+static bool sgf_points(const std::string& value, int n, Bitboard *points) {
+  *points = 0;
+  if (value.empty() || (value == "tt" && n <= 19)) return true;
+  int x0, y0, x1, y1;
+  if (value.size() == 2) {
+    x0 = x1 = value[0] - 'a';
+    y0 = y1 = value[1] - 'a';
+  } else if (value.size() == 5 && value[2] == ':') {
+    x0 = value[0] - 'a';
+    y0 = value[1] - 'a';
+    x1 = value[3] - 'a';
+    y1 = value[4] - 'a';
+  } else {
+    return false;
+  }
+  if (x0 < 0 || y0 < 0 || x1 >= n || y1 >= n || x0 > x1 || y0 > y1) {
+    return false;
+  }
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) *points |= point_bit(y * n + x);
+  }
+  return true;
+}
+
+bool parse_sgf(std::istream& in, int move_number, BatchPosition *p) {
+  std::string s((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+  size_t i = s.find('(');
+  if (i == std::string::npos) {
+    p->error = "not an SGF game";
+    return false;
+  }
+  // SGF's default size, too large unless SZ says otherwise
+  p->n = 19;
+  p->board = Board(2);
+  p->to_move = BLACK;
+  p->passes = 0;
+  p->history.clear();
+  p->superko.clear();
+  int moves = 0;
+  bool sized = false;
+  std::string name, value;
+  std::vector<std::string> values;
+
+  // the first variation is the main line, it ends at the first ')'
+  for (i++; i < s.size() && s[i] != ')'; ) {
+    if (s[i] == '(' || s[i] == ';' || std::isspace(s[i])) {
+      i++;
+      continue;
+    }
+    name.clear();
+    while (i < s.size() && std::isalpha(s[i])) name.push_back(s[i++]);
+    values.clear();
+    while (i < s.size() && (s[i] == '[' || std::isspace(s[i]))) {
+      if (s[i] == '[') {
+        if (!read_sgf_value(s, &i, &value)) break;
+        values.push_back(value);
+      } else {
+        i++;
+      }
+    }
+    if (name.empty() || values.empty()) {
+      p->error = "bad SGF property at " + std::to_string(i);
+      return false;
+    }
+
+    if (name == "SZ") {
+      p->n = std::atoi(values[0].c_str());
+      if (p->n < 2 || p->n > MAX_BOARD_SIZE) break;
+      p->board = Board(p->n);
+      sized = true;
+      continue;
+    }
+    bool setup = name == "AB" || name == "AW" || name == "AE";
+    bool move = name == "B" || name == "W";
+    if (name == "PL") {
+      p->to_move = values[0] == "W" || values[0] == "w" ? WHITE : BLACK;
+    }
+    if (!setup && !move) continue;
+    if (!sized) break;
+
+    Bitboard points = 0, point;
+    for (const std::string& v : values) {
+      if (!sgf_points(v, p->n, &point) || (move && bit_count(point) > 1)) {
+        p->error = "bad SGF point " + v;
+        return false;
+      }
+      points |= point;
+    }
+    Board& b = p->board;
+    if (setup) {
+      Bitboard black = b.stones[BLACK] & ~points;
+      Bitboard white = b.stones[WHITE] & ~points;
+      if (name == "AB") black |= points;
+      if (name == "AW") white |= points;
+      b.set_stones(black, white);
+      if (!b.legal_position()) {
+        p->error = "setup stones without liberties";
+        return false;
+      }
+    } else {
+      if (move_number > 0 && ++moves >= move_number) break;
+      Color c = name == "B" ? BLACK : WHITE;
+      if (points == 0) {
+        p->passes++;
+      } else if (!b.move(lowest_point(points), c)) {
+        p->error = "illegal move " + values[0];
+        return false;
+      } else {
+        p->passes = 0;
+      }
+      p->to_move = Go::opponent(c);
+    }
+    if (b.stones[BLACK] | b.stones[WHITE]) p->superko.push_back(b.h);
+  }
+
+  if (p->n < 2 || p->n > MAX_BOARD_SIZE) {
+    p->error = "board size must be between 2 and " +
+      std::to_string(MAX_BOARD_SIZE);
+    return false;
+  }
+  if (!sized) p->board = Board(p->n);
+  return true;
+}
+
+std::string format_batch_position(const BatchPosition& p) {
+  std::stringstream out;
+  out << p.n << " " << p.board.to_string() << " ";
+  out << (p.to_move == BLACK ? "b" : "w");
+  return out.str();
+}
+
+static bool solve_position(const BatchPosition& p, Solver *solver,
+    std::string *result) {
+  std::stringstream out;
+  out << p.line << " ";
+  if (!p.error.empty()) {
+    out << "error " << p.error;
+    *result = out.str();
+    return false;
+  }
+
+  Go game(p.n);
+  if (!p.setup(&game)) {
+    out << "error history is illegal or does not reach the board";
+    *result = out.str();
+    return false;
+  }
+
+  // earlier lines' results could have come from another superko history,
+  // and shouldn't depend on which thread solved what
+  solver->clear();
+  Clock::time_point start = Clock::now();
+  long allocations = thread_allocations();
+  int move = solver->solve(&game, p.to_move);
+  allocations = thread_allocations() - allocations;
+  auto dur = std::chrono::duration_cast<float_seconds>(Clock::now() - start);
+  out << Board::get_point_coord(move, p.n) << " ";
+  out << solver->get_result().value << " ";
+  out << solver->get_nodes() << " " << dur.count() << " " << allocations;
+  *result = out.str();
+  return true;
+}
+
+void read_batch(std::istream& in, std::vector<BatchPosition> *positions) {
+  std::string text;
+  for (int line = 1; std::getline(in, text); line++) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos || text[first] == '#') continue;
+    BatchPosition p;
+    p.line = line;
+    parse_batch_position(text, &p);
+    positions->push_back(p);
+  }
+}
+
+int run_batch(std::istream& in, std::ostream& out, int threads) {
+  std::vector<BatchPosition> positions;
+  read_batch(in, &positions);
+  return run_batch(positions, out, threads);
+}
+
+int run_batch(const std::vector<BatchPosition>& positions, std::ostream& out,
+    int threads) {
+  std::vector<std::string> results(positions.size());
+  std::vector<char> done(positions.size(), 0);
+  std::vector<char> solved(positions.size(), 0);
+  std::mutex lock;
+  std::condition_variable finished;
+  std::atomic<size_t> next(0);
+
+  auto work = [&]() {
+    Solver solver(false);
+    for (size_t i = next++; i < positions.size(); i = next++) {
+      std::string result;
+      bool ok = solve_position(positions[i], &solver, &result);
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        results[i] = result;
+        solved[i] = ok;
+        done[i] = 1;
+      }
+      finished.notify_all();
+    }
+  };
+
+  if (threads < 1) threads = 1;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) workers.emplace_back(work);
+
+  // write results in input order as soon as they are available
+  int failed = 0;
+  for (size_t i = 0; i < positions.size(); i++) {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      finished.wait(guard, [&]() { return done[i] != 0; });
+    }
+    if (!solved[i]) failed++;
+    out << results[i] << std::endl;
+  }
+
+  for (auto& w : workers) w.join();
+  return failed;
+}
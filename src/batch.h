@@ -0,0 +1,72 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Go.h"
+
+/*
+ * Solve many positions at once on a pool of threads
+ *
+ * Input has one position per line:
+ *
+ *   <size> <board> <b|w> [history]
+ *
+ * where board is the rows of the position separated by '/', top row first as
+ * showboard prints them (e.g. ".../.b./..."), followed by the side to move.
+ * The optional history is a list of moves such as "b:c2 w:b2 b:pass" played
+ * from the empty board, which must end on the given board. It is replayed so
+ * that positional superko knows every earlier position. Without a history
+ * only the given position itself is forbidden from repeating. Empty lines
+ * and lines starting with '#' are skipped.
+ *
+ * Every thread owns a Solver and takes the next unsolved position whenever
+ * it finishes one, so a few slow positions don't hold up the rest. Results
+ * are written in input order as soon as all earlier ones are done:
+ *
+ *   <line> <move> <value> <nodes> <seconds> <allocations>
+ *
+ * with the value from the point of view of the side to move and the heap
+ * allocations the solve made (see allocations.h), or
+ * "<line> error <reason>" for lines that could not be read.
+ *
+ * Positions can also come from the GTP scripts in problems/, which play
+ * moves up to the first genmove, from SGF files, or from binary position
+ * files (see position_file.h), in which case <line> is the record number.
+ * */
+
+struct BatchPosition {
+  int line;
+  int n;
+  Board board;
+  Color to_move;
+  std::vector<std::pair<Color, int>> history;
+  // without a history, the hashes of earlier positions and the passes
+  // leading to the board, as binary position files store them
+  std::vector<long> superko;
+  int passes;
+  std::string error;  // empty if the line was read correctly
+
+  BatchPosition() : line(0), n(0), board(2), to_move(BLACK), passes(0) {}
+  // build the game this position describes, false if the history is illegal
+  bool setup(Go *game) const;
+};
+
+bool parse_batch_position(const std::string& text, BatchPosition *p);
+// read the position a GTP script sets up before its first genmove
+bool parse_gtp_script(std::istream& in, BatchPosition *p);
+// read the position of an SGF game's main line before move_number, the
+// first move being 1, or after every move if it's 0. Setup stones (AB, AW,
+// AE) and PL are honored. The moves are replayed on a bare board, so the
+// position has no history, only the superko hashes of what came before.
+bool parse_sgf(std::istream& in, int move_number, BatchPosition *p);
+// "<size> <board> <b|w>", the history is not included
+std::string format_batch_position(const BatchPosition& p);
+// read every position line, including the ones that fail to parse
+void read_batch(std::istream& in, std::vector<BatchPosition> *positions);
+// returns the number of positions that failed
+int run_batch(const std::vector<BatchPosition>& positions, std::ostream& out,
+    int threads);
+int run_batch(std::istream& in, std::ostream& out, int threads);
@@ -3,44 +3,71 @@
 
 #include <iostream>
 #include <sstream>
-
-std::map<int, char> color_chars = {
-  {EMPTY, '.'}, {BLACK, 'b'}, {WHITE, 'w'}
-};
+#include "random.h"
 
 enum Border { LEFT = 0, RIGHT = 1, TOP = 2, BOTTOM = 3 };
-// will probably want to pre-compute these
-long edge_mask(unsigned short n, Border border) {
-  long mask = 0;
+constexpr Bitboard edge_mask(unsigned short n, Border border) {
+  Bitboard mask = 0;
   for (unsigned short i = 0; i < n; i++) {
     if (border == BOTTOM) {
-      mask |= 1 << i;
+      mask |= point_bit(i);
     } else if (border == TOP) {
-      mask |= 1 << (n*(n-1) + i);
+      mask |= point_bit(n*(n-1) + i);
     } else if (border == LEFT) {
-      mask |= 1 << (n*(i+1) - 1);
+      mask |= point_bit(n*(i+1) - 1);
     } else if (border == RIGHT) {
-      mask |= 1 << (n*i);
+      mask |= point_bit(n*i);
     }
   }
   return mask;
 }
 
-void Board::init_zobrist() {
-  for (int i = 0; i < 2; i++) {
-    for (int j = 0; j < 64; j++) {
-      z_table[i][j] = std::rand();
+// edge masks for every supported size
+struct EdgeMasks {
+  Bitboard masks[MAX_BOARD_SIZE + 1][4] = {{0}};
+  constexpr EdgeMasks() {
+    for (unsigned short n = 0; n <= MAX_BOARD_SIZE; n++) {
+      for (int b = LEFT; b <= BOTTOM; b++) {
+        masks[n][b] = edge_mask(n, static_cast<Border>(b));
+      }
     }
   }
+};
+static constexpr EdgeMasks edges;
+
+// logical right shift, stones in the top bit of an 8x8 board must not be
+// smeared across the board by sign extension
+static inline Bitboard shift_right(Bitboard x, int k) {
+#ifdef WIDE_BOARD
+  return x >> k;
+#else
+  return static_cast<long>(static_cast<unsigned long>(x) >> k);
+#endif
 }
 
-long Board::z_table[2][64] = {{0}};
+// zobrist keys for each color and point. They must never change, position
+// files store hashes made with them, and they are also used as
+// transposition table keys so they need all 64 bits.
+struct ZobristKeys {
+  long keys[2][MAX_POINTS] = {{0}};
+  constexpr ZobristKeys() {
+    Random rng(2019);
+    for (int i = 0; i < 2; i++) {
+      for (int j = 0; j < MAX_POINTS; j++) {
+        keys[i][j] = static_cast<long>(rng.next());
+      }
+    }
+  }
+};
+static constexpr ZobristKeys zobrist;
 
 Board::Board(int _n) : n(_n) {
   stones[BLACK] = 0;
   stones[WHITE] = 0;
   h = 0;
-  size_mask = (1 << n*n) - 1;
+  size_mask = n*n == 8 * static_cast<int>(sizeof(Bitboard)) ?
+    ~static_cast<Bitboard>(0) : point_bit(n*n) - 1;
+  count_points();
 }
 
 Board::Board(const Board& other) {
@@ -48,13 +75,17 @@ Board::Board(const Board& other) {
   stones[WHITE] = other.stones[WHITE];
   h = other.h;
   n = other.n;
+  stone_count[BLACK] = other.stone_count[BLACK];
+  stone_count[WHITE] = other.stone_count[WHITE];
+  eye_count[BLACK] = other.eye_count[BLACK];
+  eye_count[WHITE] = other.eye_count[WHITE];
   size_mask = other.size_mask;
 }
 
-void Board::update_zobrist(long group, Color color) {
-  std::bitset<64> b(group);
-  for (int i = 0; i < n*n; i++) {
-    if (b.test(i)) h ^= z_table[color][i];
+void Board::update_zobrist(Bitboard group, Color color) {
+  while (group) {
+    h ^= zobrist.keys[color][lowest_point(group)];
+    group &= group - 1;
   }
 }
 
@@ -65,79 +96,180 @@ Color Board::opponent(Color color) {
 bool Board::move(int point_ind, Color color) {
   if (point_ind < 0 || point_ind >= n*n) return false;
 
-  long point = 1 << point_ind;
+  Bitboard point = point_bit(point_ind);
   if (!(point & empty_points())) return false;
 
+  // the point stops being an eye, the same precedence as count_points
+  Bitboard around = get_neighbors(point);
+  if ((around & stones[BLACK]) == around) eye_count[BLACK]--;
+  else if ((around & stones[WHITE]) == around) eye_count[WHITE]--;
+
   // place the stone
   stones[color] |= point;
+  stone_count[color]++;
   update_zobrist(point, color);
   Color opp = opponent(color);
   // find neighbors of opponent color and check if they are captured
-  long opp_groups[4] = {0, 0, 0, 0};
-  opp_groups[0] = (point << 1) & stones[opp] & ~edge_mask(n, RIGHT);
-  opp_groups[1] = (point >> 1) & stones[opp] & ~edge_mask(n, LEFT);
+  Bitboard opp_groups[4] = {0, 0, 0, 0};
+  opp_groups[0] = (point << 1) & stones[opp] & ~edges.masks[n][RIGHT];
+  opp_groups[1] = shift_right(point, 1) & stones[opp] & ~edges.masks[n][LEFT];
   opp_groups[2] = (point << n) & stones[opp];
-  opp_groups[3] = (point >> n) & stones[opp];
+  opp_groups[3] = shift_right(point, n) & stones[opp];
 
-  long group;
+  Bitboard empty = empty_points();
+  Bitboard group, captured = 0;
   for (int i = 0; i < 4; i++) {
-    if (opp_groups[i]) {
+    // a stone with an empty neighbor can't be captured, so only flood fill
+    // neighbors that are still on the board and have no liberty of their own
+    if ((opp_groups[i] & stones[opp]) && !(adjacent(opp_groups[i]) & empty)) {
       group = get_group(opp_groups[i]);
       if (get_liberties(group) == 0) {
         // capture opponent stones
         stones[opp] &= ~group;
         update_zobrist(group, opp);
+        captured |= group;
       }
     }
   }
+  if (captured) stone_count[opp] -= bit_count(captured);
+  // the only new eyes are the stone's empty neighbors and captured points
+  // now surrounded by color. No other point gained or lost a neighbor, and
+  // the stone's empty neighbors couldn't have been eyes before.
+  Bitboard fresh = (around | captured) & empty_points();
+  if (fresh) {
+    eye_count[color] += bit_count(fresh &
+        ~adjacent(size_mask & ~stones[color]));
+  }
 
+  // check suicide, a stone next to an empty point always has a liberty
+  if (adjacent(point) & empty_points()) return true;
   group = get_group(point);
-  // check suicide
   return get_liberties(group) != 0;
 }
 
-bool Board::fills_eye(int move, Color c) {
-  long neighbors = get_neighbors(1 << move);
+bool Board::fills_eye(int move, Color c) const {
+  Bitboard neighbors = get_neighbors(point_bit(move));
   return (neighbors & stones[c]) == neighbors;
 }
 
-long Board::get_neighbors(long group) {
-  long neighbors = 0;
+Bitboard Board::get_neighbors(Bitboard group) const {
+  return adjacent(group) & ~group;
+}
+
+Bitboard Board::adjacent(Bitboard points) const {
+  Bitboard neighbors = 0;
   // shift left, remove right border neighbors
-  neighbors |= (group << 1) & ~edge_mask(n, RIGHT);
+  neighbors |= (points << 1) & ~edges.masks[n][RIGHT];
   // shift right, remove left border neighbors
-  neighbors |= (group >> 1) & ~edge_mask(n, LEFT);
+  neighbors |= shift_right(points, 1) & ~edges.masks[n][LEFT];
   // shift down, remove top border neighbors
-  neighbors |= (group << n);
+  neighbors |= (points << n);
   // shift up, remove bottomom border neighbors
-  neighbors |= (group >> n);
-  return size_mask & neighbors & ~group;
+  neighbors |= shift_right(points, n);
+  return size_mask & neighbors;
+}
+
+Bitboard Board::eyes(Color c) const {
+  // an empty point is an eye if it touches nothing but c's stones
+  return empty_points() & ~adjacent(size_mask & ~stones[c]);
+}
+
+// every point of within connected to seed
+static Bitboard flood(const Board& b, Bitboard seed, Bitboard within) {
+  Bitboard group = seed, prev = 0;
+  while (group != prev) {
+    prev = group;
+    group |= b.adjacent(group) & within;
+  }
+  return group;
 }
 
-long Board::get_liberties(long group) {
+void Board::pass_alive(Color c, Bitboard *alive, Bitboard *regions) const {
+  Bitboard own = stones[c];
+  Bitboard others = size_mask & ~own;
+  Bitboard empty = empty_points();
+  Bitboard chains[MAX_POINTS], areas[MAX_POINTS];
+  int num_chains = 0, num_areas = 0;
+  for (Bitboard rest = own; rest; rest &= ~chains[num_chains++]) {
+    chains[num_chains] = flood(*this, rest & -rest, own);
+  }
+  for (Bitboard rest = others; rest; rest &= ~areas[num_areas++]) {
+    areas[num_areas] = flood(*this, rest & -rest, others);
+  }
+
+  // drop chains with fewer than two regions whose empty points are all
+  // their liberties, then regions next to a dropped chain, until neither
+  // changes
+  Bitboard living = own, enclosed = others;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = 0; i < num_chains; i++) {
+      if (!(chains[i] & living)) continue;
+      Bitboard liberties = adjacent(chains[i]) & empty;
+      int vital = 0;
+      for (int j = 0; j < num_areas && vital < 2; j++) {
+        if ((areas[j] & enclosed) && (adjacent(areas[j]) & chains[i]) &&
+            !(areas[j] & empty & ~liberties)) {
+          vital++;
+        }
+      }
+      if (vital < 2) {
+        living &= ~chains[i];
+        changed = true;
+      }
+    }
+    for (int j = 0; j < num_areas; j++) {
+      if ((areas[j] & enclosed) && (adjacent(areas[j]) & own & ~living)) {
+        enclosed &= ~areas[j];
+        changed = true;
+      }
+    }
+  }
+  if (alive != nullptr) *alive = living;
+  if (regions != nullptr) *regions = living ? enclosed : 0;
+}
+
+Bitboard Board::settled(Color c) const {
+  // eyes need at least two stones around them, so a single stone or none
+  // can't be alive
+  if (bit_count(stones[c]) < 2) return 0;
+  Bitboard alive;
+  pass_alive(c, &alive, nullptr);
+  if (!alive) return 0;
+  // the opponent can't play in these, it would be suicide
+  Bitboard eyes = empty_points() & ~adjacent(size_mask & ~alive);
+  return alive | eyes;
+}
+
+int Board::settled_points(Color c) const {
+  return bit_count(settled(c));
+}
+
+Bitboard Board::get_liberties(Bitboard group) const {
   return get_neighbors(group) & ~(stones[BLACK] | stones[WHITE]);
 }
 
-bool Board::atari(int point_ind) {
-  long group = get_group(1 << point_ind);
-  return __builtin_popcountl(get_liberties(group)) <= 1;
+bool Board::atari(int point_ind) const {
+  Bitboard group = get_group(point_bit(point_ind));
+  return bit_count(get_liberties(group)) <= 1;
 }
 
-long Board::get_group(long board_point) {
-  long group = board_point;
-  long black_mask = board_point & stones[BLACK];
-  long white_mask = board_point & stones[WHITE];
+Bitboard Board::get_group(Bitboard board_point) const {
+  Bitboard group = board_point;
+  Bitboard black_mask = board_point & stones[BLACK];
+  Bitboard white_mask = board_point & stones[WHITE];
 
   // check if point empty
   if (!(white_mask | black_mask)) return group;
 
   // figure out which color it actually is
-  long color_mask = black_mask != 0 ? stones[BLACK] : stones[WHITE];
+  Bitboard color_mask = black_mask != 0 ? stones[BLACK] : stones[WHITE];
 
   // iteratively compute neighboring points of same color by computing
   // neighbors and masking based on color
   // if we get no change, we're done
-  long old = 0;
+  Bitboard old = 0;
   while (group != old) {
     old = group;
     group = (group | get_neighbors(group)) & color_mask;
@@ -146,44 +278,153 @@ long Board::get_group(long board_point) {
   return group;
 }
 
-float Board::score(Color color) {
-  // the following is not portable to non-GNU compilers, if this is a problem
-  // we can find a workaround
-  int b = __builtin_popcountl(stones[BLACK]);
-  int w = __builtin_popcountl(stones[WHITE]);
-  std::bitset<64> empty(empty_points());
-  for (int i = 0; i < n*n; i++) {
-    if (empty.test(i)) {
-      // have an empty point, check if all neighbors are one color
-      long point = 1 << i;
-      long neighbors = get_neighbors(point);
-      if ((neighbors & stones[BLACK]) == neighbors) b++;
-      else if ((neighbors & stones[WHITE]) == neighbors) w++;
-    }
-  }
-
+float Board::score(Color color) const {
+  int b = stone_count[BLACK] + eye_count[BLACK];
+  int w = stone_count[WHITE] + eye_count[WHITE];
   float score = color == BLACK ? 1.0 * (b-w) : 1.0 * (w-b);
   return score;
 }
 
+int Board::score_delta(int point_ind, Color c) const {
+  // the same changes move makes to the counts
+  Bitboard point = point_bit(point_ind);
+  Color opp = opponent(c);
+  Bitboard around = get_neighbors(point);
+  int delta = 1;
+  if ((around & stones[BLACK]) == around) delta += c == BLACK ? -1 : 1;
+  else if ((around & stones[WHITE]) == around) delta += c == WHITE ? -1 : 1;
+
+  Bitboard captured = captures(point_ind, c);
+  delta += bit_count(captured);
+  // surrounded by c once the stone is placed and the captures removed
+  Bitboard own = stones[c] | point;
+  Bitboard empty = size_mask & ~(own | (stones[opp] & ~captured));
+  Bitboard eyes = empty & ~adjacent(size_mask & ~own);
+  return delta + bit_count((around | captured) & eyes);
+}
+
 void Board::print() const {
-  std::bitset<64> b(stones[BLACK]);
-  std::bitset<64> w(stones[WHITE]);
   Color color;
   std::cout << std::endl;
   for (int i = 0; i < n; i++) {
     for (int j = 0; j < n; j++) {
+      Bitboard point = point_bit(i*n + j);
       color = EMPTY;
-      if (b.test(i*n + j)) color = BLACK;
-      else if (w.test(i*n + j)) color = WHITE;
-      std::cout << color_chars[color];
+      if (stones[BLACK] & point) color = BLACK;
+      else if (stones[WHITE] & point) color = WHITE;
+      std::cout << color_char(color);
     }
     std::cout << std::endl;
   }
   std::cout << std::endl;
 }
 
-long Board::empty_points() const {
+Bitboard Board::captures(int point_ind, Color c) const {
+  Bitboard point = point_bit(point_ind);
+  Bitboard captured = 0;
+  for (Bitboard rest = get_neighbors(point) & stones[opponent(c)]; rest;
+      rest &= rest - 1) {
+    if (rest & -rest & captured) continue;
+    Bitboard group = get_group(rest & -rest);
+    if (!(get_liberties(group) & ~point)) captured |= group;
+  }
+  return captured;
+}
+
+int Board::liberties_after(int point_ind, Color c) const {
+  Bitboard point = point_bit(point_ind);
+  if (!(point & empty_points())) return 0;
+  Bitboard group = flood(*this, point, stones[c] | point);
+  Bitboard empty = (empty_points() & ~point) | captures(point_ind, c);
+  return bit_count(adjacent(group) & empty);
+}
+
+bool Board::hash_after(int point_ind, Color c, long *hash) const {
+  Bitboard point = point_bit(point_ind);
+  Bitboard captured = captures(point_ind, c);
+  if (!captured && !(get_neighbors(point) & empty_points())) {
+    // suicide unless the group it joins has another liberty
+    Bitboard group = flood(*this, point, stones[c] | point);
+    if (!(get_liberties(group) & ~point)) return false;
+  }
+  long h_after = h ^ zobrist.keys[c][point_ind];
+  for (; captured; captured &= captured - 1) {
+    h_after ^= zobrist.keys[opponent(c)][lowest_point(captured)];
+  }
+  *hash = h_after;
+  return true;
+}
+
+void Board::set_stones(Bitboard black, Bitboard white) {
+  stones[BLACK] = black & size_mask;
+  stones[WHITE] = white & size_mask & ~stones[BLACK];
+  h = 0;
+  update_zobrist(stones[BLACK], BLACK);
+  update_zobrist(stones[WHITE], WHITE);
+  count_points();
+}
+
+void Board::count_points() {
+  stone_count[BLACK] = bit_count(stones[BLACK]);
+  stone_count[WHITE] = bit_count(stones[WHITE]);
+  // a point with no neighbors at all counts for black, as in score
+  Bitboard black_eyes = eyes(BLACK);
+  eye_count[BLACK] = bit_count(black_eyes);
+  eye_count[WHITE] = bit_count(eyes(WHITE) & ~black_eyes);
+}
+
+bool Board::legal_position() {
+  for (int c = BLACK; c <= WHITE; c++) {
+    Bitboard remaining = stones[c];
+    while (remaining) {
+      Bitboard group = get_group(remaining & -remaining);
+      if (get_liberties(group) == 0) return false;
+      remaining &= ~group;
+    }
+  }
+  return true;
+}
+
+std::string Board::to_string() const {
+  std::string s;
+  for (int i = 0; i < n; i++) {
+    if (i > 0) s += '/';
+    for (int j = 0; j < n; j++) {
+      Bitboard point = point_bit(i*n + j);
+      Color color = EMPTY;
+      if (stones[BLACK] & point) color = BLACK;
+      else if (stones[WHITE] & point) color = WHITE;
+      s += color_char(color);
+    }
+  }
+  return s;
+}
+
+bool Board::from_string(const std::string& s, int _n, Board *b) {
+  Bitboard black = 0, white = 0;
+  int row = 0, col = 0;
+  for (char ch : s) {
+    if (ch == '/') {
+      if (col != _n) return false;
+      row++;
+      col = 0;
+      continue;
+    }
+    if (row >= _n || col >= _n) return false;
+    Bitboard point = point_bit(row*_n + col);
+    if (ch == color_char(BLACK)) black |= point;
+    else if (ch == color_char(WHITE)) white |= point;
+    else if (ch != color_char(EMPTY)) return false;
+    col++;
+  }
+  if (row != _n - 1 || col != _n) return false;
+
+  *b = Board(_n);
+  b->set_stones(black, white);
+  return b->legal_position();
+}
+
+Bitboard Board::empty_points() const {
   return size_mask & ~(stones[BLACK] | stones[WHITE]);
 }
 
@@ -195,3 +436,12 @@ std::string Board::get_point_coord(int point_ind, int _n) {
   ss << static_cast<char>('a' + row) << col + 1;
   return ss.str();
 }
+
+std::string Board::get_vertex(int point_ind, int _n) {
+  if (point_ind < 0) return "pass";
+  int row = point_ind / _n;
+  int col = point_ind % _n;
+  std::stringstream ss;
+  ss << "ABCDEFGHJKL"[col] << _n - row;
+  return ss.str();
+}
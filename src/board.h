@@ -1,45 +1,126 @@
 // Copyright 2019 Chris Solinas
 #pragma once
 
-#include <bitset>
-#include <map>
+#include <cstdint>
+#include <string>
 
 // Globals to help callers use consistent values
 enum Color { EMPTY = -1, BLACK = 0, WHITE = 1 };
-extern std::map<int, char> color_chars;
+constexpr char color_char(Color c) {
+  return c == BLACK ? 'b' : c == WHITE ? 'w' : '.';
+}
+
+// one bit per point, row by row from the least significant bit. A long
+// holds boards up to 8x8, building with -DWIDE_BOARD (make wide) switches to
+// 128 bits for boards up to 11x11.
+#ifdef WIDE_BOARD
+typedef unsigned __int128 Bitboard;
+constexpr int MAX_BOARD_SIZE = 11;
+#else
+typedef long Bitboard;
+constexpr int MAX_BOARD_SIZE = 8;
+#endif
+constexpr int MAX_POINTS = MAX_BOARD_SIZE * MAX_BOARD_SIZE;
+
+constexpr Bitboard point_bit(int point_ind) {
+  return static_cast<Bitboard>(1) << point_ind;
+}
+
+inline int bit_count(Bitboard b) {
+#ifdef WIDE_BOARD
+  return __builtin_popcountll(static_cast<uint64_t>(b)) +
+    __builtin_popcountll(static_cast<uint64_t>(b >> 64));
+#else
+  return __builtin_popcountl(b);
+#endif
+}
+
+// index of the lowest set bit, b must not be empty
+inline int lowest_point(Bitboard b) {
+#ifdef WIDE_BOARD
+  uint64_t low = static_cast<uint64_t>(b);
+  return low ? __builtin_ctzll(low) :
+    64 + __builtin_ctzll(static_cast<uint64_t>(b >> 64));
+#else
+  return __builtin_ctzl(b);
+#endif
+}
 
 /*
  * Bit board used to represent states in the game
- * Works for board up to 8x8 
+ * Works for boards up to MAX_BOARD_SIZE
+ *
+ * Boards share no mutable state, the zobrist keys and edge masks are
+ * constants computed at compile time, so any number of threads can play and
+ * search their own games at once.
  * */
 struct Board {
-  long stones[2];  // one for BLACK, one for WHITE
+  Bitboard stones[2];  // one for BLACK, one for WHITE
   long h;  // zobrist hash value for positional superko testing
   unsigned short n;
-  long size_mask;
+  // stones of each color and empty points whose neighbors are all that
+  // color's stones, kept up to date by move so scoring needs no scan
+  uint8_t stone_count[2];
+  uint8_t eye_count[2];
+  Bitboard size_mask;
 
   Board(int _n);
   Board(const Board& other);
+  Board& operator=(const Board& other) = default;
 
   bool move(int point_ind, Color color);
   // return the neighboring points of group
-  long get_neighbors(long group);
+  Bitboard get_neighbors(Bitboard group) const;
+  // return every point next to one of points, including points in the set
+  Bitboard adjacent(Bitboard points) const;
+  // return the empty points whose neighbors are all c's stones
+  Bitboard eyes(Color c) const;
+  // Benson's algorithm: the stones of c that can't be captured even if c
+  // always passes, and the regions enclosed only by those stones. Either
+  // pointer may be nullptr.
+  void pass_alive(Color c, Bitboard *alive, Bitboard *regions) const;
+  // stones of c that can never be captured plus the empty points next to
+  // nothing but those stones, neither can ever change hands
+  Bitboard settled(Color c) const;
+  int settled_points(Color c) const;
   // return the liberties of group
-  long get_liberties(long group);
-  bool atari(int point_ind);
+  Bitboard get_liberties(Bitboard group) const;
+  bool atari(int point_ind) const;
   // return the group of stones stone at position point is part of
-  long get_group(long board_point);
-  float score(Color color);
+  Bitboard get_group(Bitboard board_point) const;
+  // area score: stones plus empty points surrounded by one color
+  float score(Color color) const;
+  // how much c's score changes if c plays the legal move point_ind, without
+  // playing it
+  int score_delta(int point_ind, Color c) const;
+  // the opponent's stones c would capture by playing the empty point
+  // point_ind
+  Bitboard captures(int point_ind, Color c) const;
+  // liberties of the group c's stone on point_ind would join, without
+  // playing it, 0 if the move is illegal (superko aside)
+  int liberties_after(int point_ind, Color c) const;
+  // the hash after c plays the empty point point_ind without playing it,
+  // false if the move would be suicide
+  bool hash_after(int point_ind, Color c, long *hash) const;
   static Color opponent(Color color);
-  void update_zobrist(long group, Color color);
-  bool fills_eye(int move, Color c);
+  void update_zobrist(Bitboard group, Color color);
+  bool fills_eye(int move, Color c) const;
+
+  // replace every stone on the board and recompute the hash and counts
+  void set_stones(Bitboard black, Bitboard white);
+  // recount stone_count and eye_count from scratch
+  void count_points();
+  // true if every group on the board has at least one liberty
+  bool legal_position();
 
   // helper functions
-  long empty_points() const;
+  Bitboard empty_points() const;
   void print() const;
+  // rows of color_char separated by '/', in the order print shows them
+  std::string to_string() const;
+  static bool from_string(const std::string& s, int _n, Board *b);
   static std::string get_point_coord(int point_ind, int _n);
-
-  static long z_table[2][64];
-  static void init_zobrist();
+  // the point as a GTP vertex, see Go::parse_vertex
+  static std::string get_vertex(int point_ind, int _n);
 };
 
@@ -1,106 +1,544 @@
 // Copyright 2019 Chris Solinas
 #include "gtp_interface.h"
 
-#include <iostream>
+#include <strings.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include "board.h"
 
-std::regex GTP_interface::show_reg("showboard");
-std::regex GTP_interface::move_reg("play (b|w) [[:alpha:]][[:digit:]]");
-std::regex GTP_interface::genmove_reg("genmove (b|w)");
-std::regex GTP_interface::genmove_binary_reg("genmove (b|w) -?[[:digit:]]+");
-std::regex GTP_interface::undo_reg("undo");
-std::regex GTP_interface::legal_reg("legal (b|w)");
-std::regex GTP_interface::score_reg("score");
-std::regex GTP_interface::quit_reg("quit");
-
-void GTP_interface::listen() {
-  std::string cmd;
-  while (1) {
-    if (std::cin.eof()) break;
-    std::getline(std::cin, cmd);
-    if (std::regex_match(cmd, quit_reg)) {
-      break;
+const GTP_interface::Command GTP_interface::commands[] = {
+  {"boardsize", &GTP_interface::boardsize_cmd},
+  {"clear_board", &GTP_interface::clear_board_cmd},
+  {"engine", &GTP_interface::engine_cmd},
+  {"final_score", &GTP_interface::final_score_cmd},
+  {"genmove", &GTP_interface::gen_move_cmd},
+  {"known_command", &GTP_interface::known_command_cmd},
+  {"komi", &GTP_interface::komi_cmd},
+  {"legal", &GTP_interface::get_legal_moves_cmd},
+  {"list_commands", &GTP_interface::list_commands_cmd},
+  {"loadsgf", &GTP_interface::loadsgf_cmd},
+  {"name", &GTP_interface::name_cmd},
+  {"perft", &GTP_interface::perft_cmd},
+  {"play", &GTP_interface::play_move_cmd},
+  {"ponder", &GTP_interface::ponder_cmd},
+  {"protocol_version", &GTP_interface::protocol_version_cmd},
+  {"quit", &GTP_interface::quit_cmd},
+  {"score", &GTP_interface::score_cmd},
+  {"setboard", &GTP_interface::setboard_cmd},
+  {"showboard", &GTP_interface::show_board_cmd},
+  {"solver_option", &GTP_interface::solver_option_cmd},
+  {"stats", &GTP_interface::stats_cmd},
+  {"stop", &GTP_interface::stop_cmd},
+  {"undo", &GTP_interface::undo_move_cmd},
+  {"version", &GTP_interface::version_cmd},
+  {nullptr, nullptr}
+};
+
+const GTP_interface::Command* GTP_interface::find_command(const char *name) {
+  for (const Command *cmd = commands; cmd->name != nullptr; cmd++) {
+    if (std::strcmp(cmd->name, name) == 0) return cmd;
+  }
+  return nullptr;
+}
+
+// the command name of a line, skipping its id, or "" if there is none
+static std::string command_name(const std::string& line) {
+  std::stringstream ss(line.substr(0, line.find('#')));
+  std::string word;
+  ss >> word;
+  if (!word.empty() && word.find_first_not_of("0123456789") == word.npos) {
+    ss >> word;
+  }
+  return word;
+}
+
+void GTP_interface::read_input(std::istream *in) {
+  std::string line;
+  while (std::getline(*in, line)) {
+    std::string name = command_name(line);
+    bool interrupt = name.empty() &&
+      line.find("# interrupt") != std::string::npos;
+    {
+      std::lock_guard<std::mutex> guard(input_lock);
+      if (name == "stop") pending_stops++;
+      if ((name == "stop" || interrupt) && searching) {
+        solver->stop();
+        mcts->stop();
+      }
+      if (!interrupt) input.push_back(line);
+    }
+    input_ready.notify_one();
+    // nothing after quit is read
+    if (name == "quit") break;
+  }
+  std::lock_guard<std::mutex> guard(input_lock);
+  input_done = true;
+  input_ready.notify_one();
+}
+
+bool GTP_interface::next_line(std::string *line) {
+  std::unique_lock<std::mutex> guard(input_lock);
+  input_ready.wait(guard, [this]() { return !input.empty() || input_done; });
+  if (input.empty()) return false;
+  *line = std::move(input.front());
+  input.pop_front();
+  return true;
+}
+
+void GTP_interface::listen(std::istream& in, std::ostream& os) {
+  input_done = false;
+  set_info(verbose);
+  std::thread reader(&GTP_interface::read_input, this, &in);
+  std::string line;
+  bool more = true;
+  while (more && next_line(&line)) {
+    out.clear();
+    more = execute(&line, &out);
+    os.write(out.data(), out.size());
+    os.flush();
+    bool idle;
+    {
+      std::lock_guard<std::mutex> guard(input_lock);
+      idle = input.empty();
+    }
+    if (more && idle) start_pondering();
+  }
+  stop_pondering();
+  // the reader stops by itself after quit or at the end of the input
+  reader.join();
+  input.clear();
+  set_info(false);
+}
+
+void GTP_interface::begin_search() {
+  std::lock_guard<std::mutex> guard(input_lock);
+  searching = true;
+  // a stop read before the search started still applies to it
+  if (pending_stops > 0) {
+    solver->stop();
+    mcts->stop();
+  }
+}
+
+void GTP_interface::end_search() {
+  std::lock_guard<std::mutex> guard(input_lock);
+  searching = false;
+  solver->clear_stop();
+  mcts->clear_stop();
+}
+
+void GTP_interface::set_info(bool on) {
+  solver->set_info(on ? &std::clog : nullptr);
+  mcts->set_info(on ? &std::clog : nullptr);
+}
+
+bool GTP_interface::use_mcts() {
+  return engine == MCTS_ENGINE ||
+    (engine == AUTO_ENGINE && game->size() > EXACT_SOLVE_MAX_SIZE);
+}
+
+void GTP_interface::start_pondering() {
+  if (!ponder || ponder_thread.joinable() || game->game_over()) return;
+  ponder_game = *game;
+  Color c = ponder_game.to_play();
+  solver->set_verbose(false);
+  mcts->set_verbose(false);
+  set_info(false);
+  bool mcts_ponder = use_mcts();
+  ponder_thread = std::thread([this, c, mcts_ponder]() {
+    if (mcts_ponder) {
+      mcts->ponder(&ponder_game, c);
     } else {
-      execute(cmd);
+      solver->solve(&ponder_game, c);
+    }
+  });
+}
+
+void GTP_interface::stop_pondering() {
+  if (!ponder_thread.joinable()) return;
+  solver->stop();
+  mcts->stop();
+  ponder_thread.join();
+  solver->clear_stop();
+  mcts->clear_stop();
+  solver->set_verbose(verbose);
+  mcts->set_verbose(verbose);
+  set_info(verbose);
+}
+
+bool GTP_interface::execute(std::string *line, std::string *output) {
+  stop_pondering();
+
+  // drop control characters and comments and turn tabs into spaces
+  std::string& l = *line;
+  size_t len = 0;
+  for (size_t i = 0; i < l.size() && l[i] != '#'; i++) {
+    char ch = l[i] == '\t' ? ' ' : l[i];
+    if ((ch >= 0 && ch < ' ') || ch == 127) continue;
+    l[len++] = ch;
+  }
+  l.resize(len);
+
+  // split on spaces in place, the arguments point into the line
+  args.clear();
+  for (size_t i = 0; i < len; i++) {
+    if (l[i] == ' ') {
+      l[i] = '\0';
+    } else if (i == 0 || l[i - 1] == '\0') {
+      args.push_back(&l[i]);
     }
   }
+  if (args.empty()) return !quit;
+
+  const char *id = "";
+  if (std::strspn(args[0], "0123456789") == std::strlen(args[0])) {
+    id = args[0];
+    args.erase(args.begin());
+  }
+
+  answer.clear();
+  bool ok = false;
+  const Command *cmd = args.empty() ? nullptr : find_command(args[0]);
+  if (cmd != nullptr) {
+    ok = (this->*cmd->handler)(&answer);
+  } else {
+    answer = "unknown command";
+  }
+
+  // frame the response, it may not contain empty lines
+  output->push_back(ok ? '=' : '?');
+  output->append(id);
+  output->push_back(' ');
+  for (char ch : answer) {
+    if (ch == '\n' && output->back() == '\n') continue;
+    output->push_back(ch);
+  }
+  if (output->back() == '\n') output->pop_back();
+  output->append("\n\n");
+  return !quit;
 }
 
-bool GTP_interface::execute(std::string cmd) {
-  bool legal = true;
-
-  if (std::regex_match(cmd, show_reg)) {
-    legal = show_board_cmd();
-  } else if (std::regex_match(cmd, move_reg)) {
-    legal = play_move_cmd(cmd);
-  } else if (std::regex_match(cmd, genmove_reg)) {
-    legal = gen_move_cmd(cmd);
-  } else if (std::regex_match(cmd, genmove_binary_reg)) {
-    legal = gen_move_binary_cmd(cmd);
-  } else if (std::regex_match(cmd, undo_reg)) {
-    legal = undo_move_cmd();
-  } else if (std::regex_match(cmd, legal_reg)) {
-    legal = get_legal_moves_cmd(cmd);
-  } else if (std::regex_match(cmd, score_reg)) {
-    legal = score_cmd();
+bool GTP_interface::parse_color(size_t arg, Color *c) {
+  if (arg >= args.size()) return false;
+  const char *s = args[arg];
+  if (strcasecmp(s, "b") == 0 || strcasecmp(s, "black") == 0) {
+    *c = BLACK;
+  } else if (strcasecmp(s, "w") == 0 || strcasecmp(s, "white") == 0) {
+    *c = WHITE;
   } else {
-    legal = false;
+    return false;
   }
+  return true;
+}
+
+bool GTP_interface::parse_point(size_t arg, int *point_ind) {
+  if (arg >= args.size()) return false;
+  return Go::parse_vertex(args[arg], game->size(), point_ind);
+}
+
+bool GTP_interface::parse_int(size_t arg, int *value) {
+  if (arg >= args.size()) return false;
+  char *end;
+  long v = std::strtol(args[arg], &end, 10);
+  if (*end != '\0' || end == args[arg]) return false;
+  *value = v;
+  return true;
+}
+
+bool GTP_interface::protocol_version_cmd(std::string *response) {
+  *response = "2";
+  return true;
+}
 
-  if (!legal) msg_illegal(cmd);
-  return legal;
+bool GTP_interface::name_cmd(std::string *response) {
+  *response = "small_go";
+  return true;
 }
 
-void GTP_interface::msg_illegal(std::string cmd) {
-  std::cout << "Illegal cmd: " << cmd << std::endl;
+bool GTP_interface::version_cmd(std::string *response) {
+  *response = "1.0";
+  return true;
 }
 
-bool GTP_interface::show_board_cmd() {
-  game->print_board();
+bool GTP_interface::known_command_cmd(std::string *response) {
+  bool known = args.size() > 1 && find_command(args[1]) != nullptr;
+  *response = known ? "true" : "false";
   return true;
 }
 
-bool GTP_interface::play_move_cmd(std::string cmd) {
-  // tokenize cmd string, kind of ugly but simple
-  std::string tmp;
-  char color, x, y;
-  std::stringstream is(cmd);
-  is >> tmp >> color >> x >> y;
-  int row = x - 'a';
-  int col = y - '1';
-  Color c = color == 'b' ? BLACK : WHITE;
-  return game->make_move(row * game->size() + col, c);
+bool GTP_interface::list_commands_cmd(std::string *response) {
+  for (const Command *cmd = commands; cmd->name != nullptr; cmd++) {
+    if (cmd != commands) response->push_back('\n');
+    response->append(cmd->name);
+  }
+  return true;
 }
 
-bool GTP_interface::gen_move_cmd(std::string cmd) {
-  std::string tmp;
-  char color;
-  std::stringstream is(cmd);
-  is >> tmp >> color;
-  Color c = color =='b' ? BLACK : WHITE;
-  int move = solver->solve(game, c);
-  return game->make_move(move, c);
+bool GTP_interface::quit_cmd(std::string *) {
+  quit = true;
+  return true;
 }
 
-bool GTP_interface::gen_move_binary_cmd(std::string cmd) {
-  std::string tmp;
-  char color;
-  int max_value;
-  std::stringstream is(cmd);
-  is >> tmp >> color >> max_value;
-  Color c = color =='b' ? BLACK : WHITE;
-  int move = solver->solve(game, c, max_value);
-  return game->make_move(move, c);
+bool GTP_interface::boardsize_cmd(std::string *response) {
+  int n;
+  if (!parse_int(1, &n)) {
+    *response = "syntax error";
+    return false;
+  }
+  if (n < 2 || n > MAX_BOARD_SIZE) {
+    *response = "unacceptable size";
+    return false;
+  }
+  *game = Go(n);
+  solver->clear();
+  mcts->clear();
+  return true;
 }
 
-bool GTP_interface::undo_move_cmd() { return game->undo_move(); }
+bool GTP_interface::clear_board_cmd(std::string *) {
+  *game = Go(game->size());
+  solver->clear();
+  mcts->clear();
+  return true;
+}
 
-bool GTP_interface::get_legal_moves_cmd(std::string) {
-  return false;
+void GTP_interface::set_position(const BatchPosition& p) {
+  p.setup(game);
+  game->set_to_play(p.to_move);
+  solver->clear();
+  mcts->clear();
 }
 
-bool GTP_interface::score_cmd() {
-  std::cout << game->score(BLACK) << std::endl;
+bool GTP_interface::setboard_cmd(std::string *response) {
+  BatchPosition p;
+  std::string rows = args.size() > 1 ? args[1] : "";
+  p.n = std::count(rows.begin(), rows.end(), '/') + 1;
+  if (p.n < 2 || p.n > MAX_BOARD_SIZE ||
+      !Board::from_string(rows, p.n, &p.board) || !parse_color(2, &p.to_move)) {
+    *response = "syntax error";
+    return false;
+  }
+  for (size_t i = 3; i < args.size(); i++) {
+    Board earlier(p.n);
+    if (!Board::from_string(args[i], p.n, &earlier)) {
+      *response = "syntax error";
+      return false;
+    }
+    if (earlier.h != 0) p.superko.push_back(earlier.h);
+  }
+  set_position(p);
   return true;
 }
 
+bool GTP_interface::loadsgf_cmd(std::string *response) {
+  int move_number = 0;
+  if (args.size() < 2 || (args.size() > 2 && !parse_int(2, &move_number))) {
+    *response = "syntax error";
+    return false;
+  }
+  std::ifstream in(args[1]);
+  BatchPosition p;
+  if (!in) {
+    *response = "cannot load file";
+    return false;
+  }
+  if (!parse_sgf(in, move_number, &p)) {
+    *response = p.error;
+    return false;
+  }
+  set_position(p);
+  return true;
+}
+
+bool GTP_interface::komi_cmd(std::string *response) {
+  char *end;
+  float value = args.size() > 1 ? std::strtof(args[1], &end) : 0;
+  if (args.size() < 2 || *end != '\0') {
+    *response = "syntax error";
+    return false;
+  }
+  komi = value;
+  return true;
+}
+
+bool GTP_interface::show_board_cmd(std::string *response) {
+  response->push_back('\n');
+  for (char ch : game->get_board().to_string()) {
+    response->push_back(ch == '/' ? '\n' : ch);
+  }
+  return true;
+}
+
+bool GTP_interface::play_move_cmd(std::string *response) {
+  Color c;
+  int move;
+  if (!parse_color(1, &c) || !parse_point(2, &move)) {
+    *response = "syntax error";
+    return false;
+  }
+  if (!game->make_move(move, c)) {
+    *response = "illegal move";
+    return false;
+  }
+  return true;
+}
+
+bool GTP_interface::gen_move_cmd(std::string *response) {
+  Color c;
+  int max_value = 0;
+  if (!parse_color(1, &c) || (args.size() > 2 && !parse_int(2, &max_value))) {
+    *response = "syntax error";
+    return false;
+  }
+
+  int move;
+  begin_search();
+  if (args.size() > 2) {
+    move = solver->solve(game, c, max_value);
+  } else {
+    move = use_mcts() ? mcts->search(game, c) : solver->solve(game, c);
+  }
+  end_search();
+
+  if (!game->make_move(move, c)) {
+    *response = "engine chose an illegal move";
+    return false;
+  }
+  *response = Board::get_vertex(move, game->size());
+  return true;
+}
+
+bool GTP_interface::undo_move_cmd(std::string *response) {
+  if (!game->undo_move()) {
+    *response = "cannot undo";
+    return false;
+  }
+  return true;
+}
+
+bool GTP_interface::get_legal_moves_cmd(std::string *response) {
+  Color c;
+  if (!parse_color(1, &c)) {
+    *response = "syntax error";
+    return false;
+  }
+  std::vector<int> moves;
+  game->get_moves(&moves);
+  for (int move : moves) {
+    if (!game->make_move(move, c)) continue;
+    game->undo_move();
+    if (!response->empty()) response->push_back(' ');
+    response->append(Board::get_vertex(move, game->size()));
+  }
+  return true;
+}
+
+bool GTP_interface::score_cmd(std::string *response) {
+  std::stringstream ss;
+  ss << game->score(BLACK);
+  *response = ss.str();
+  return true;
+}
+
+bool GTP_interface::final_score_cmd(std::string *response) {
+  float score = game->score(BLACK) - komi;
+  std::stringstream ss;
+  if (score > 0) {
+    ss << "B+" << score;
+  } else if (score < 0) {
+    ss << "W+" << -score;
+  } else {
+    ss << "0";
+  }
+  *response = ss.str();
+  return true;
+}
+
+bool GTP_interface::perft_cmd(std::string *response) {
+  Color c;
+  int depth;
+  if (!parse_color(1, &c) || !parse_int(2, &depth) || depth < 0) {
+    *response = "syntax error";
+    return false;
+  }
+  std::stringstream ss;
+  print_perft(perft_divide(game, c, depth), game->size(), ss);
+  *response = ss.str();
+  return true;
+}
+
+bool GTP_interface::stats_cmd(std::string *response) {
+  std::stringstream ss;
+  if (args.size() > 1 && std::strcmp(args[1], "json") == 0) {
+    solver->get_stats().to_json(ss);
+  } else if (args.size() > 1) {
+    *response = "syntax error";
+    return false;
+  } else {
+    solver->get_stats().print(ss);
+  }
+  *response = ss.str();
+  return true;
+}
+
+bool GTP_interface::engine_cmd(std::string *response) {
+  const char *name = args.size() > 1 ? args[1] : "";
+  if (std::strcmp(name, "solver") == 0) {
+    engine = SOLVER_ENGINE;
+  } else if (std::strcmp(name, "mcts") == 0) {
+    engine = MCTS_ENGINE;
+  } else if (std::strcmp(name, "auto") == 0) {
+    engine = AUTO_ENGINE;
+  } else {
+    *response = "syntax error";
+    return false;
+  }
+  return true;
+}
+
+bool GTP_interface::ponder_cmd(std::string *response) {
+  const char *value = args.size() > 1 ? args[1] : "";
+  if (std::strcmp(value, "on") == 0) {
+    ponder = true;
+  } else if (std::strcmp(value, "off") == 0) {
+    ponder = false;
+  } else {
+    *response = "syntax error";
+    return false;
+  }
+  return true;
+}
+
+bool GTP_interface::solver_option_cmd(std::string *response) {
+  const char *name = args.size() > 1 ? args[1] : "";
+  const char *value = args.size() > 2 ? args[2] : "";
+  bool on = std::strcmp(value, "on") == 0;
+  if (!on && std::strcmp(value, "off") != 0) {
+    *response = "syntax error";
+    return false;
+  }
+  if (std::strcmp(name, "pvs") == 0) {
+    solver->set_pvs(on);
+  } else if (std::strcmp(name, "safety") == 0) {
+    solver->set_safety_pruning(on);
+  } else if (std::strcmp(name, "regions") == 0) {
+    solver->set_decomposition(on);
+  } else if (std::strcmp(name, "etc") == 0) {
+    solver->set_etc(on);
+  } else {
+    *response = "unknown option";
+    return false;
+  }
+  return true;
+}
+
+bool GTP_interface::stop_cmd(std::string *) {
+  // the search it was meant for has already been stopped by the reader
+  std::lock_guard<std::mutex> guard(input_lock);
+  if (pending_stops > 0) pending_stops--;
+  return true;
+}
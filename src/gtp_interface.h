@@ -6,41 +6,141 @@ Command line interface that is compatible with programs such as gogui
 via GTP
 **/
 
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
 #include <string>
-#include <regex>
+#include <thread>
+#include <vector>
 #include "Go.h"
+#include "batch.h"
 #include "solver.h"
+#include "perft.h"
+#include "mcts.h"
 
+// largest board genmove solves exactly when the engine is left on auto
+constexpr int EXACT_SOLVE_MAX_SIZE = 3;
 
+enum Engine { AUTO_ENGINE, SOLVER_ENGINE, MCTS_ENGINE };
 
+/*
+ * Commands are read a line at a time and split in place, so arguments point
+ * straight into the line buffer. The command name is looked up in a static
+ * table of handlers and each handler writes its answer into a response
+ * buffer, which is framed as "=[id] answer" or "?[id] error" and written
+ * with a single flush per command.
+ *
+ * listen reads input on a thread of its own and runs commands in order on
+ * the calling thread. A "stop" command or a "# interrupt" line (as sent by
+ * GoGui) reaches a running genmove straight away, which then answers with
+ * the best move it has so far. stop itself is answered in turn like any
+ * other command. While verbose, searches write "info" progress lines with
+ * depth, score, pv and speed to the log.
+ *
+ * With pondering on, the engine keeps searching the position on a background
+ * thread while it waits for the next command. Any command stops it first,
+ * so commands never run alongside a search. The solver's table of proven
+ * results and the MCTS trees outlive the search, so whatever applies to the
+ * position after the opponent's reply makes the next genmove faster.
+ *
+ * Points are GTP vertices, see Go::parse_vertex: a column letter that skips
+ * I, then the row counted from the bottom, e.g. "A1" is the bottom left
+ * corner and "B2" the center of a 3x3 board. showboard, batch results and
+ * info lines keep the internal coordinates.
+ *
+ * Besides playing moves one at a time, a position can be set up at once with
+ * "setboard <rows> <b|w> [earlier rows...]", using the rows format of batch
+ * files, or read from an SGF file with "loadsgf <file> [move number]". Both
+ * build the game straight from the board, any earlier positions only go into
+ * its superko history, so setting up takes the same time however many moves
+ * led to the position.
+ * */
 class GTP_interface {
+ public:
+  // a handler returns false if the command failed, the response then holds
+  // the error message
+  typedef bool (GTP_interface::*Handler)(std::string *response);
+  struct Command {
+    const char *name;
+    Handler handler;
+  };
+
  private:
   Go *game;
   Solver *solver;
+  MCTS *mcts;
+  Engine engine;
+  float komi;
   bool verbose;
-  bool execute(std::string cmd);
-  void msg_illegal(std::string cmd);
+  bool quit;
+  bool ponder;
+  // searches a copy of the game so commands can't change it underneath
+  std::thread ponder_thread;
+  Go ponder_game;
+  // lines read but not yet run, shared with the input thread
+  std::mutex input_lock;
+  std::condition_variable input_ready;
+  std::deque<std::string> input;
+  bool input_done;
+  int pending_stops;  // stop commands read but not yet run
+  bool searching;
+  // arguments of the command being run, pointing into the line buffer
+  std::vector<const char*> args;
+  std::string answer;
+  std::string out;
+
+  static const Command commands[];
+  static const Command* find_command(const char *name);
+  bool parse_color(size_t arg, Color *c);
+  bool parse_point(size_t arg, int *point_ind);
+  bool parse_int(size_t arg, int *value);
+  bool use_mcts();
+  // replace the game with a position and forget what the engines know
+  void set_position(const BatchPosition& p);
+  void start_pondering();
+  void stop_pondering();
+  void read_input(std::istream *in);
+  bool next_line(std::string *line);
+  // bracket an engine search so stops that arrive meanwhile reach it
+  void begin_search();
+  void end_search();
+  void set_info(bool on);
+
   // commands
-  bool show_board_cmd();
-  bool play_move_cmd(std::string cmd);
-  bool gen_move_cmd(std::string cmd);
-  bool gen_move_binary_cmd(std::string cmd);
-  bool undo_move_cmd();
-  bool get_legal_moves_cmd(std::string cmd);
-  bool score_cmd();
-  // regex for command strings
-  static std::regex show_reg;
-  static std::regex move_reg;
-  static std::regex genmove_reg;
-  static std::regex genmove_binary_reg;
-  static std::regex undo_reg;
-  static std::regex legal_reg;
-  static std::regex score_reg;
-  static std::regex quit_reg;
+  bool protocol_version_cmd(std::string *response);
+  bool name_cmd(std::string *response);
+  bool version_cmd(std::string *response);
+  bool known_command_cmd(std::string *response);
+  bool list_commands_cmd(std::string *response);
+  bool quit_cmd(std::string *response);
+  bool boardsize_cmd(std::string *response);
+  bool clear_board_cmd(std::string *response);
+  bool setboard_cmd(std::string *response);
+  bool loadsgf_cmd(std::string *response);
+  bool komi_cmd(std::string *response);
+  bool show_board_cmd(std::string *response);
+  bool play_move_cmd(std::string *response);
+  bool gen_move_cmd(std::string *response);
+  bool undo_move_cmd(std::string *response);
+  bool get_legal_moves_cmd(std::string *response);
+  bool score_cmd(std::string *response);
+  bool final_score_cmd(std::string *response);
+  bool perft_cmd(std::string *response);
+  bool stats_cmd(std::string *response);
+  bool engine_cmd(std::string *response);
+  bool ponder_cmd(std::string *response);
+  bool solver_option_cmd(std::string *response);
+  bool stop_cmd(std::string *response);
 
  public:
-  GTP_interface(Go *_game, Solver *_solver, bool _verbose) : game(_game),
-    solver(_solver), verbose(_verbose) {}
-  void listen();
+  GTP_interface(Go *_game, Solver *_solver, MCTS *_mcts, bool _verbose) :
+    game(_game), solver(_solver), mcts(_mcts), engine(AUTO_ENGINE), komi(0),
+    verbose(_verbose), quit(false), ponder(false), ponder_game(2),
+    input_done(false), pending_stops(0), searching(false) {}
+  ~GTP_interface() { stop_pondering(); }
+  void listen(std::istream& in = std::cin, std::ostream& os = std::cout);
+  // run one line of input and append its framed response to *output,
+  // returns false once quit has been received
+  bool execute(std::string *line, std::string *output);
 };
-
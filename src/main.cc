@@ -1,13 +1,160 @@
 // Copyright 2019 Chris Solinas
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Go.h"
+#include "batch.h"
 #include "gtp_interface.h"
+#include "position_file.h"
+#include "random_games.h"
+#include "tuner.h"
 
-int main() {
-  Go game(3);
+// usage: small_go [board size]
+//        small_go batch [positions file] [threads]
+//        small_go convert [-s history slots] <input>... <output>
+//        small_go generate [-e] [-t threads] [-s seed] <size> <games> <output>
+//        small_go tune [-e epochs] [-h holdout] <positions> <header>
+int main(int argc, char *argv[]) {
+  if (argc > 1 && std::strcmp(argv[1], "generate") == 0) {
+    bool eye_aware = false;
+    int threads = std::thread::hardware_concurrency();
+    uint64_t seed = 2019;
+    int arg = 2;
+    for (; arg < argc && argv[arg][0] == '-'; arg++) {
+      if (std::strcmp(argv[arg], "-e") == 0) {
+        eye_aware = true;
+      } else if (std::strcmp(argv[arg], "-t") == 0 && arg + 1 < argc) {
+        threads = std::atoi(argv[++arg]);
+      } else if (std::strcmp(argv[arg], "-s") == 0 && arg + 1 < argc) {
+        seed = std::strtoull(argv[++arg], nullptr, 10);
+      } else {
+        break;
+      }
+    }
+    if (argc - arg != 3) {
+      std::cerr << "usage: small_go generate [-e] [-t threads] [-s seed] "
+        "<size> <games> <output>" << std::endl;
+      return 1;
+    }
+    GeneratorResult r = generate_games(std::atoi(argv[arg]),
+        std::atol(argv[arg + 1]), eye_aware, seed, threads, argv[arg + 2]);
+    if (!r.error.empty()) {
+      std::cerr << r.error << std::endl;
+      return 1;
+    }
+    std::cerr << "games: " << r.games << " moves: " << r.moves;
+    std::cerr << " games/sec: " << r.games / std::max(r.seconds, 1e-6f);
+    std::cerr << std::endl;
+    return 0;
+  }
+
+  if (argc > 1 && std::strcmp(argv[1], "tune") == 0) {
+    int epochs = 40, holdout = 4;
+    int arg = 2;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+      if (std::strcmp(argv[arg], "-e") == 0) {
+        epochs = std::atoi(argv[arg + 1]);
+      } else if (std::strcmp(argv[arg], "-h") == 0) {
+        holdout = std::atoi(argv[arg + 1]);
+      } else {
+        break;
+      }
+    }
+    if (argc - arg != 2) {
+      std::cerr << "usage: small_go tune [-e epochs] [-h holdout] "
+        "<positions> <header>" << std::endl;
+      return 1;
+    }
+    std::vector<BatchPosition> positions;
+    std::string error;
+    if (PositionReader::is_position_file(argv[arg])) {
+      if (!read_position_file(argv[arg], &positions, &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+      }
+    } else {
+      std::ifstream in(argv[arg]);
+      if (!in) {
+        std::cerr << "can't open " << argv[arg] << std::endl;
+        return 1;
+      }
+      read_batch(in, &positions);
+    }
+    OrderingWeights w = tuned_ordering();
+    TuneResult r = tune_ordering(positions, holdout, epochs, &w);
+    std::cerr << "positions: " << r.train << " samples: " << r.samples;
+    std::cerr << " held out: " << r.test << "\n";
+    std::cerr << "held out log likelihood: " << r.likelihood_before << " -> ";
+    std::cerr << r.likelihood_after << "\n";
+    std::cerr << "held out nodes: " << r.nodes_before << " -> ";
+    std::cerr << r.nodes_after << std::endl;
+    if (!r.values_match) {
+      std::cerr << "values changed with the new weights" << std::endl;
+      return 1;
+    }
+    std::ofstream out(argv[arg + 1]);
+    write_ordering_header(w, out);
+    return out ? 0 : 1;
+  }
+
+  if (argc > 1 && std::strcmp(argv[1], "convert") == 0) {
+    int slots = DEFAULT_HISTORY_SLOTS;
+    int first = 2;
+    if (argc > 3 && std::strcmp(argv[2], "-s") == 0) {
+      slots = std::atoi(argv[3]);
+      first = 4;
+    }
+    if (argc - first < 2) {
+      std::cerr << "usage: small_go convert [-s history slots] <input>... "
+        "<output>" << std::endl;
+      return 1;
+    }
+    std::vector<std::string> inputs(argv + first, argv + argc - 1);
+    return convert_positions(inputs, argv[argc - 1], slots, std::cerr) == 0 ?
+      0 : 1;
+  }
+
+  if (argc > 1 && std::strcmp(argv[1], "batch") == 0) {
+    int threads = std::thread::hardware_concurrency();
+    if (argc > 3) threads = std::atoi(argv[3]);
+    if (argc > 2 && PositionReader::is_position_file(argv[2])) {
+      std::vector<BatchPosition> positions;
+      std::string error;
+      if (!read_position_file(argv[2], &positions, &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+      }
+      return run_batch(positions, std::cout, threads) == 0 ? 0 : 1;
+    }
+    if (argc > 2 && std::strcmp(argv[2], "-") != 0) {
+      std::ifstream in(argv[2]);
+      if (!in) {
+        std::cerr << "can't open " << argv[2] << std::endl;
+        return 1;
+      }
+      return run_batch(in, std::cout, threads) == 0 ? 0 : 1;
+    }
+    return run_batch(std::cin, std::cout, threads) == 0 ? 0 : 1;
+  }
+
+  int n = 3;
+  if (argc > 1) n = std::atoi(argv[1]);
+  if (n < 2 || n > MAX_BOARD_SIZE) {
+    std::cerr << "board size must be between 2 and " << MAX_BOARD_SIZE;
+    std::cerr << std::endl;
+    return 1;
+  }
+
+  Go game(n);
   Solver solver;
-  GTP_interface gtp(&game, &solver, true);
+  MCTS mcts;
+  GTP_interface gtp(&game, &solver, &mcts, true);
   gtp.listen();
   return 0;
 }
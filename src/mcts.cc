@@ -0,0 +1,368 @@
+// Copyright 2019 Chris Solinas
+#include "mcts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <thread>
+#include "solver.h"
+#include "transposition_table.h"
+
+static inline float reward_for(Color c, float black_reward) {
+  return c == BLACK ? black_reward : 1 - black_reward;
+}
+
+MCTSTree::MCTSTree() : root_color(BLACK) {}
+
+void MCTSTree::set_root(Go *game, Color c) {
+  long key = TranspositionTable::key(game->get_board(), c,
+      game->last_move_was_pass());
+  if (!nodes.empty() && reroot(key, c)) return;
+
+  nodes.clear();
+  nodes.push_back({UNDEFINED, -1, 0, 0, 0, 0, 0, key});
+  root_color = c;
+}
+
+bool MCTSTree::reroot(long key, Color c) {
+  int target = -1;
+  if (c == root_color) {
+    if (nodes[0].key == key) return true;
+    // look two plies down, our last move and the opponent's reply
+    for (int i = 0; i < nodes[0].num_children && target < 0; i++) {
+      const MCTSNode& child = nodes[nodes[0].first_child + i];
+      for (int j = 0; j < child.num_children; j++) {
+        int ind = child.first_child + j;
+        if (nodes[ind].visits > 0 && nodes[ind].key == key) {
+          target = ind;
+          break;
+        }
+      }
+    }
+  } else {
+    for (int i = 0; i < nodes[0].num_children; i++) {
+      int ind = nodes[0].first_child + i;
+      if (nodes[ind].visits > 0 && nodes[ind].key == key) {
+        target = ind;
+        break;
+      }
+    }
+  }
+  if (target < 0) return false;
+
+  // copy the subtree breadth first so that siblings stay contiguous
+  std::vector<MCTSNode> kept;
+  std::vector<int> old_index;
+  kept.push_back(nodes[target]);
+  old_index.push_back(target);
+  for (size_t i = 0; i < kept.size(); i++) {
+    const MCTSNode& old = nodes[old_index[i]];
+    if (old.first_child < 0) continue;
+    kept[i].first_child = kept.size();
+    for (int j = 0; j < old.num_children; j++) {
+      kept.push_back(nodes[old.first_child + j]);
+      old_index.push_back(old.first_child + j);
+    }
+  }
+  nodes.swap(kept);
+  root_color = c;
+  return true;
+}
+
+void MCTSTree::expand(int parent, Go *game, Color c) {
+  const Board& b = game->get_board();
+  Bitboard candidates = b.empty_points() & ~b.eyes(c);
+  nodes[parent].first_child = nodes.size();
+  nodes[parent].num_children = bit_count(candidates) + 1;
+  while (candidates) {
+    int move = lowest_point(candidates);
+    candidates &= candidates - 1;
+    nodes.push_back({move, -1, 0, 0, 0, 0, 0, 0});
+  }
+  nodes.push_back({PASS_IND, -1, 0, 0, 0, 0, 0, 0});
+}
+
+int MCTSTree::select(int parent) {
+  const MCTSNode& p = nodes[parent];
+  float log_visits = std::log(p.visits + 1.0);
+  int best = -1;
+  float best_value = -1;
+  for (int i = 0; i < p.num_children; i++) {
+    const MCTSNode& child = nodes[p.first_child + i];
+    if (child.move == ILLEGAL_IND) continue;
+
+    float amaf = child.amaf_visits > 0 ? child.amaf_wins / child.amaf_visits
+      : 0.5;
+    float value;
+    if (child.visits == 0) {
+      // try every child once, most promising by all moves as first first
+      value = 10 + amaf;
+    } else {
+      float q = child.wins / child.visits;
+      float beta = std::sqrt(MCTS_RAVE_K / (3 * child.visits + MCTS_RAVE_K));
+      value = (1 - beta) * q + beta * amaf +
+        MCTS_UCT_C * std::sqrt(log_visits / child.visits);
+    }
+    if (value > best_value) {
+      best_value = value;
+      best = p.first_child + i;
+    }
+  }
+  return best;
+}
+
+float MCTSTree::playout(Go *game, Color c, Random *rng) {
+  Board b(game->get_board());
+  int passes = game->last_move_was_pass() ? 1 : 0;
+  int max_length = 3 * b.n * b.n;
+  for (int length = 0; passes < 2 && length < max_length; length++) {
+    Bitboard candidates = b.empty_points() & ~b.eyes(c);
+    int move = PASS_IND;
+    while (candidates) {
+      int point = rng->choose_bit(candidates);
+      Board next(b);
+      if (next.move(point, c)) {
+        b = next;
+        move = point;
+        break;
+      }
+      // suicide, try another point
+      candidates &= ~point_bit(point);
+    }
+    passes = move == PASS_IND ? passes + 1 : 0;
+    moves.push_back(move);
+    c = Board::opponent(c);
+  }
+
+  float score = b.score(BLACK);
+  return score > 0 ? 1 : (score < 0 ? 0 : 0.5);
+}
+
+void MCTSTree::update(float black_reward) {
+  Color opp = Board::opponent(root_color);
+  // points played first by each color from move i to the end
+  Bitboard played[2] = {0, 0};
+  for (int i = moves.size() - 1; i >= 0; i--) {
+    Color x = i % 2 == 0 ? root_color : opp;
+    if (moves[i] >= 0) {
+      Bitboard point = point_bit(moves[i]);
+      played[x] |= point;
+      played[Board::opponent(x)] &= ~point;
+    }
+    if (i >= static_cast<int>(path.size())) continue;
+
+    MCTSNode& parent = nodes[path[i]];
+    float reward = reward_for(x, black_reward);
+    for (int j = 0; j < parent.num_children; j++) {
+      MCTSNode& child = nodes[parent.first_child + j];
+      if (child.move >= 0 && (played[x] & point_bit(child.move))) {
+        child.amaf_visits += 1;
+        child.amaf_wins += reward;
+      }
+    }
+  }
+
+  nodes[0].visits += 1;
+  for (size_t k = 1; k < path.size(); k++) {
+    Color x = (k - 1) % 2 == 0 ? root_color : opp;
+    nodes[path[k]].visits += 1;
+    nodes[path[k]].wins += reward_for(x, black_reward);
+  }
+}
+
+void MCTSTree::iterate(Go *game, Random *rng) {
+  path.clear();
+  moves.clear();
+  path.push_back(0);
+  Color c = root_color;
+  int node = 0;
+  int made = 0;
+  int n = game->size();
+
+  while (!game->game_over()) {
+    if (nodes[node].first_child < 0) {
+      if (node != 0 && nodes[node].visits < MCTS_EXPAND_VISITS) break;
+      if (nodes.size() + n*n + 1 > MCTS_MAX_NODES) break;
+      expand(node, game, c);
+    }
+
+    int child = select(node);
+    if (!game->make_move(nodes[child].move, c)) {
+      // only superko or suicide can get here, never try it again
+      nodes[child].move = ILLEGAL_IND;
+      continue;
+    }
+    made++;
+    nodes[child].key = TranspositionTable::key(game->get_board(),
+        Go::opponent(c), game->last_move_was_pass());
+    node = child;
+    path.push_back(child);
+    moves.push_back(nodes[child].move);
+    c = Go::opponent(c);
+  }
+
+  float black_reward;
+  if (game->game_over()) {
+    float score = game->score(BLACK);
+    black_reward = score > 0 ? 1 : (score < 0 ? 0 : 0.5);
+  } else {
+    black_reward = playout(game, c, rng);
+  }
+  update(black_reward);
+
+  for (int i = 0; i < made; i++) game->undo_move();
+}
+
+void MCTSTree::principal_variation(std::vector<int> *pv, int max_len) const {
+  pv->clear();
+  int ind = 0;
+  for (int ply = 0; ply < max_len && nodes[ind].first_child >= 0; ply++) {
+    int best = -1;
+    for (int i = 0; i < nodes[ind].num_children; i++) {
+      const MCTSNode& child = nodes[nodes[ind].first_child + i];
+      if (child.move == ILLEGAL_IND || child.visits == 0) continue;
+      if (best < 0 || child.visits > nodes[best].visits) {
+        best = nodes[ind].first_child + i;
+      }
+    }
+    if (best < 0) break;
+    pv->push_back(nodes[best].move);
+    ind = best;
+  }
+}
+
+const MCTSNode* MCTSTree::children(int *count) const {
+  *count = nodes[0].num_children;
+  if (nodes[0].first_child < 0) return nullptr;
+  return &nodes[nodes[0].first_child];
+}
+
+MCTS::MCTS() : MCTS(true) {}
+
+MCTS::MCTS(bool _verbose) : max_playouts(200000), max_seconds(10),
+  verbose(_verbose), searches(0), stopping(false), info(nullptr) {
+  set_threads(std::thread::hardware_concurrency());
+}
+
+void MCTS::set_threads(int _threads) {
+  threads = _threads > 0 ? _threads : 1;
+  trees.resize(threads);
+}
+
+void MCTS::clear() {
+  trees.assign(threads, MCTSTree());
+}
+
+void MCTS::grow(Go *game, Color c, long limit, float seconds,
+    std::vector<long> *playouts) {
+  searches += 1;
+  Clock::time_point start = Clock::now();
+  playouts->assign(threads, 0);
+  std::vector<std::thread> workers;
+  std::atomic<long> total(0);
+
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([this, game, c, t, limit, seconds, start, playouts,
+        &total]() {
+      Go local(*game);
+      Random rng(searches * 7919 + t);
+      MCTSTree& tree = trees[t];
+      tree.set_root(&local, c);
+      float next_info = INFO_SECONDS;
+      long done = 0;
+      while (done < limit) {
+        tree.iterate(&local, &rng);
+        done++;
+        // a few milliseconds of playouts between checks on large boards
+        if ((done & 63) == 0) {
+          total += 64;
+          if (stopping.load(std::memory_order_relaxed)) break;
+          float elapsed = std::chrono::duration_cast<float_seconds>(
+              Clock::now() - start).count();
+          if (elapsed > seconds) break;
+          // the first thread reports for everyone, from its own tree
+          if (t == 0 && info != nullptr && elapsed >= next_info) {
+            print_info(tree, total, elapsed, game->size());
+            next_info = elapsed + INFO_SECONDS;
+          }
+        }
+      }
+      (*playouts)[t] = done;
+    });
+  }
+  for (auto& w : workers) w.join();
+}
+
+void MCTS::print_info(const MCTSTree& tree, long playouts, float seconds,
+    int board_size) {
+  std::vector<int> pv;
+  tree.principal_variation(&pv, INFO_PV_LENGTH);
+  const MCTSNode& root = tree.root();
+  int count;
+  const MCTSNode *children = tree.children(&count);
+  float winrate = 0;
+  for (int i = 0; children != nullptr && i < count; i++) {
+    if (!pv.empty() && children[i].move == pv[0] && children[i].visits > 0) {
+      winrate = children[i].wins / children[i].visits;
+    }
+  }
+  std::ostream& os = *info;
+  os << "info playouts " << playouts << " nps " << playouts / seconds;
+  os << " visits " << root.visits << " winrate " << winrate << " pv";
+  for (int move : pv) os << " " << Board::get_point_coord(move, board_size);
+  os << std::endl;
+}
+
+void MCTS::ponder(Go *game, Color c) {
+  std::vector<long> playouts;
+  grow(game, c, std::numeric_limits<long>::max(),
+      std::numeric_limits<float>::infinity(), &playouts);
+}
+
+int MCTS::search(Go *game, Color c) {
+  Clock::time_point start = Clock::now();
+  std::vector<long> playouts;
+  grow(game, c, std::max(1L, max_playouts / threads), max_seconds, &playouts);
+
+  // sum the root statistics of every thread
+  std::map<int, std::pair<long, float>> totals;
+  for (auto& tree : trees) {
+    int count;
+    const MCTSNode *children = tree.children(&count);
+    for (int i = 0; children != nullptr && i < count; i++) {
+      if (children[i].move == ILLEGAL_IND) continue;
+      auto& total = totals[children[i].move];
+      total.first += children[i].visits;
+      total.second += children[i].wins;
+    }
+  }
+
+  int best_move = PASS_IND;
+  long best_visits = -1;
+  float best_wins = 0;
+  for (auto& total : totals) {
+    if (total.second.first > best_visits) {
+      best_move = total.first;
+      best_visits = total.second.first;
+      best_wins = total.second.second;
+    }
+  }
+
+  if (verbose) {
+    long all = 0;
+    for (long p : playouts) all += p;
+    auto dur = std::chrono::duration_cast<float_seconds>(Clock::now() - start);
+    std::clog << "mcts move: " << Board::get_point_coord(best_move,
+        game->size());
+    std::clog << " visits: " << best_visits;
+    std::clog << " winrate: " << (best_visits > 0 ? best_wins / best_visits
+        : 0);
+    std::clog << " playouts: " << all;
+    std::clog << " playouts/sec: " << all / dur.count();
+    std::clog << " threads: " << threads << std::endl;
+  }
+  return best_move;
+}
@@ -0,0 +1,107 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+#include "Go.h"
+#include "random.h"
+
+/*
+ * Monte Carlo tree search for boards too large to solve exactly
+ *
+ * Every thread grows its own tree from the same root and the root visit
+ * counts are summed to choose a move, so threads share nothing while
+ * searching. Children are chosen by UCT with RAVE (all moves as first)
+ * estimates blended in. Playouts run on plain Board copies and play uniformly
+ * random moves that neither fill the mover's own eyes nor commit suicide.
+ * They ignore superko, which the tree still enforces through Go::make_move.
+ *
+ * Trees are kept between searches. When the new position is found within
+ * two plies of the previous root the subtree below it is reused. Positions
+ * are told apart by their transposition table key, so the same board after a
+ * pass, which could end the game, isn't mistaken for it.
+ * */
+
+constexpr int MCTS_EXPAND_VISITS = 8;
+constexpr int MCTS_MAX_NODES = 1 << 19;  // per thread
+constexpr float MCTS_UCT_C = 0.2;
+constexpr float MCTS_RAVE_K = 1000;
+constexpr int ILLEGAL_IND = -3;
+
+struct MCTSNode {
+  int move;
+  int first_child;  // index of the first child in the tree, -1 for leaves
+  int num_children;
+  int visits;
+  float wins;  // from the point of view of the player that made move
+  int amaf_visits;
+  float amaf_wins;
+  // TranspositionTable::key of the position after move, set once the node
+  // is first visited
+  long key;
+};
+
+class MCTSTree {
+  std::vector<MCTSNode> nodes;
+  Color root_color;
+  // moves made since the root, kept between iterations to avoid allocation
+  std::vector<int> path;
+  std::vector<int> moves;
+
+  int select(int parent);
+  void expand(int parent, Go *game, Color c);
+  float playout(Go *game, Color c, Random *rng);
+  void update(float black_reward);
+  bool reroot(long key, Color c);
+
+ public:
+  MCTSTree();
+  // make game's current position the root, reusing what applies
+  void set_root(Go *game, Color c);
+  void iterate(Go *game, Random *rng);
+  const MCTSNode& root() const { return nodes[0]; }
+  const MCTSNode* children(int *count) const;
+  // the most visited line from the root, at most max_len moves
+  void principal_variation(std::vector<int> *pv, int max_len) const;
+  long size() const { return nodes.size(); }
+};
+
+class MCTS {
+  int threads;
+  long max_playouts;
+  float max_seconds;
+  bool verbose;
+  long searches;
+  std::vector<MCTSTree> trees;
+  std::atomic<bool> stopping;
+  std::ostream *info;
+
+  // run playouts on every thread until limit, seconds or stop is reached
+  void grow(Go *game, Color c, long limit, float seconds,
+      std::vector<long> *playouts);
+  void print_info(const MCTSTree& tree, long playouts, float seconds,
+      int board_size);
+
+ public:
+  MCTS();
+  explicit MCTS(bool _verbose);
+  int search(Go *game, Color c);
+  // grow the trees for the position until stop is called, e.g. while the
+  // opponent thinks. A later search from here or just after reuses them.
+  void ponder(Go *game, Color c);
+  // searches stop at whichever limit is reached first
+  void set_playouts(long playouts) { max_playouts = playouts; }
+  void set_time(float seconds) { max_seconds = seconds; }
+  void set_threads(int _threads);
+  void set_verbose(bool _verbose) { verbose = _verbose; }
+  // make a running search or ponder return as soon as possible. Stays in
+  // effect until clear_stop is called.
+  void stop() { stopping = true; }
+  void clear_stop() { stopping = false; }
+  // write progress lines to os every INFO_SECONDS while searching, nullptr
+  // for none
+  void set_info(std::ostream *os) { info = os; }
+  // forget every tree, e.g. when a new game starts
+  void clear();
+};
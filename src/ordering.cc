@@ -0,0 +1,158 @@
+// Copyright 2019 Chris Solinas
+#include "ordering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <sstream>
+#include "ordering_weights.h"
+
+const OrderingWeights& tuned_ordering() { return TUNED_ORDERING_WEIGHTS; }
+
+bool move_features(const Board& b, int move, Color c, MoveFeatures *f) {
+  *f = {move, 0, 0, 0, 0, 0, 0};
+  if (move < 0) return true;
+  int liberties = b.liberties_after(move, c);
+  if (liberties == 0) return false;
+
+  Color opp = Board::opponent(c);
+  int n = b.n, row = move / n, col = move % n;
+  // up, down, left and right, then the diagonals
+  static const int rows[8] = {-1, 1, 0, 0, -1, -1, 1, 1};
+  static const int cols[8] = {0, 0, -1, 1, -1, 1, -1, 1};
+  int pattern = 0, own = 0, other = 0;
+  for (int k = 0; k < 8; k++) {
+    int r = row + rows[k], q = col + cols[k];
+    int state = 3;
+    if (r >= 0 && r < n && q >= 0 && q < n) {
+      Bitboard point = point_bit(r * n + q);
+      state = b.stones[c] & point ? 1 : b.stones[opp] & point ? 2 : 0;
+    }
+    if (k < 4) {
+      pattern = pattern * 4 + state;
+    } else {
+      own += state == 1;
+      other += state == 2;
+    }
+  }
+  f->pattern = pattern;
+  f->diagonal = own * 5 + other;
+
+  f->liberties = std::min(liberties, ORDERING_LIBERTIES) - 1;
+  int captures = bit_count(b.captures(move, c));
+  f->captures = std::min(captures, ORDERING_CAPTURES - 1);
+  int gain = b.score_delta(move, c);
+  f->gain = std::max(0, std::min(gain, ORDERING_GAINS - 1));
+  int edge = std::min(std::min(row, col), std::min(n - 1 - row, n - 1 - col));
+  f->edge = std::min(edge, ORDERING_EDGES - 1);
+  return true;
+}
+
+float ordering_score(const OrderingWeights& w, const MoveFeatures& f) {
+  if (f.move < 0) return w.pass;
+  return w.pattern[f.pattern] + w.diagonal[f.diagonal] +
+    w.liberties[f.liberties] + w.captures[f.captures] + w.gain[f.gain] +
+    w.edge[f.edge];
+}
+
+// the weights as one array, and the entries a move's score adds up
+static constexpr int WEIGHT_COUNT = sizeof(OrderingWeights) / sizeof(float);
+static_assert(sizeof(OrderingWeights) == WEIGHT_COUNT * sizeof(float),
+    "weights must be plain floats");
+
+static int weight_indices(const MoveFeatures& f, int *indices) {
+  if (f.move < 0) {
+    indices[0] = offsetof(OrderingWeights, pass) / sizeof(float);
+    return 1;
+  }
+  indices[0] = offsetof(OrderingWeights, pattern) / sizeof(float) + f.pattern;
+  indices[1] = offsetof(OrderingWeights, diagonal) / sizeof(float) +
+    f.diagonal;
+  indices[2] = offsetof(OrderingWeights, liberties) / sizeof(float) +
+    f.liberties;
+  indices[3] = offsetof(OrderingWeights, captures) / sizeof(float) +
+    f.captures;
+  indices[4] = offsetof(OrderingWeights, gain) / sizeof(float) + f.gain;
+  indices[5] = offsetof(OrderingWeights, edge) / sizeof(float) + f.edge;
+  return 6;
+}
+
+// softmax probabilities of a sample's moves, returns the log probability of
+// the best one
+static double move_probabilities(const OrderingSample& s,
+    const OrderingWeights& w, std::vector<double> *p) {
+  p->resize(s.moves.size());
+  double top = -INFINITY;
+  for (size_t i = 0; i < s.moves.size(); i++) {
+    (*p)[i] = ordering_score(w, s.moves[i]);
+    top = std::max(top, (*p)[i]);
+  }
+  double sum = 0;
+  for (double& x : *p) sum += x = std::exp(x - top);
+  for (double& x : *p) x /= sum;
+  return std::log(std::max((*p)[s.best], 1e-300));
+}
+
+double ordering_likelihood(const std::vector<OrderingSample>& samples,
+    const OrderingWeights& w) {
+  if (samples.empty()) return 0;
+  std::vector<double> p;
+  double total = 0;
+  for (const OrderingSample& s : samples) {
+    total += move_probabilities(s, w, &p);
+  }
+  return total / samples.size();
+}
+
+void fit_ordering(const std::vector<OrderingSample>& samples, int epochs,
+    OrderingWeights *w) {
+  // stochastic gradient ascent with a learning rate that decays per epoch
+  // and a little L2 regularization so rare features stay near zero
+  const double rate = 0.1, decay = 1e-4;
+  float *weights = reinterpret_cast<float*>(w);
+  std::vector<double> p;
+  int indices[6];
+  for (int epoch = 0; epoch < epochs; epoch++) {
+    double step = rate / (1 + epoch);
+    for (const OrderingSample& s : samples) {
+      move_probabilities(s, *w, &p);
+      for (size_t i = 0; i < s.moves.size(); i++) {
+        double g = (static_cast<int>(i) == s.best) - p[i];
+        int count = weight_indices(s.moves[i], indices);
+        for (int k = 0; k < count; k++) {
+          float& x = weights[indices[k]];
+          x += step * (g - decay * x);
+        }
+      }
+    }
+  }
+}
+
+static void write_row(std::ostream& os, const char *name, const float *w,
+    int count) {
+  os << "  // " << name << "\n  {";
+  for (int i = 0; i < count; i++) {
+    if (i > 0) os << (i % 7 == 0 ? ",\n   " : ",");
+    os << " " << w[i] << "f";
+  }
+  os << "},\n";
+}
+
+void write_ordering_header(const OrderingWeights& w, std::ostream& os) {
+  std::ostringstream body;
+  body << std::fixed << std::setprecision(4);
+  body << "// Copyright 2019 Chris Solinas\n";
+  body << "// Generated by small_go tune, see ordering.h\n";
+  body << "#pragma once\n\n";
+  body << "#include \"ordering.h\"\n\n";
+  body << "constexpr OrderingWeights TUNED_ORDERING_WEIGHTS = {\n";
+  write_row(body, "pattern", w.pattern, ORDERING_PATTERNS);
+  write_row(body, "diagonal", w.diagonal, ORDERING_DIAGONALS);
+  write_row(body, "liberties", w.liberties, ORDERING_LIBERTIES);
+  write_row(body, "captures", w.captures, ORDERING_CAPTURES);
+  write_row(body, "gain", w.gain, ORDERING_GAINS);
+  write_row(body, "edge", w.edge, ORDERING_EDGES);
+  body << "  // pass\n  " << w.pass << "f\n};\n";
+  os << body.str();
+}
@@ -0,0 +1,68 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "board.h"
+
+/*
+ * Move ordering from weights fit to the solver's own cutoffs
+ *
+ * Every move is described by a few small features of the board before and
+ * after it is played: the four points next to it (empty, own, opponent or off
+ * the board), how many diagonal points hold own and opponent stones, the
+ * liberties of the group it joins, the stones it captures, how much area it
+ * gains and how far it is from the edge. A move's priority is the sum of one
+ * weight per feature, and moves are searched highest priority first.
+ *
+ * The weights are fit offline by "small_go tune", which solves a corpus of
+ * positions, records the move that turned out best at every node that found
+ * one, and maximizes the likelihood of those moves under a softmax over each
+ * node's legal moves. The result is written to ordering_weights.h.
+ * */
+
+constexpr int ORDERING_PATTERNS = 256;  // 4 states for each of 4 neighbors
+constexpr int ORDERING_DIAGONALS = 25;  // 0-4 own and 0-4 opponent stones
+constexpr int ORDERING_LIBERTIES = 4;   // 1, 2, 3, 4 or more
+constexpr int ORDERING_CAPTURES = 4;    // 0, 1, 2, 3 or more
+constexpr int ORDERING_GAINS = 8;       // score change 0-7 or more
+constexpr int ORDERING_EDGES = 4;       // rows from the edge 0-3 or more
+
+struct OrderingWeights {
+  float pattern[ORDERING_PATTERNS];
+  float diagonal[ORDERING_DIAGONALS];
+  float liberties[ORDERING_LIBERTIES];
+  float captures[ORDERING_CAPTURES];
+  float gain[ORDERING_GAINS];
+  float edge[ORDERING_EDGES];
+  float pass;
+};
+
+// the weights in ordering_weights.h
+const OrderingWeights& tuned_ordering();
+
+struct MoveFeatures {
+  int move;
+  uint8_t pattern, diagonal, liberties, captures, gain, edge;
+};
+
+// describe move for c, false if it is illegal (superko aside). Passes are
+// always legal.
+bool move_features(const Board& b, int move, Color c, MoveFeatures *f);
+float ordering_score(const OrderingWeights& w, const MoveFeatures& f);
+
+// a node and the move that proved best there
+struct OrderingSample {
+  std::vector<MoveFeatures> moves;
+  int best;  // index into moves
+};
+
+// maximize the log likelihood of the samples' best moves, starting from *w
+void fit_ordering(const std::vector<OrderingSample>& samples, int epochs,
+    OrderingWeights *w);
+// mean log likelihood of the samples' best moves
+double ordering_likelihood(const std::vector<OrderingSample>& samples,
+    const OrderingWeights& w);
+// write the weights as a header that defines TUNED_ORDERING_WEIGHTS
+void write_ordering_header(const OrderingWeights& w, std::ostream& os);
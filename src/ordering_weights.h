@@ -0,0 +1,62 @@
+// Copyright 2019 Chris Solinas
+// Generated by small_go tune, see ordering.h
+#pragma once
+
+#include "ordering.h"
+
+constexpr OrderingWeights TUNED_ORDERING_WEIGHTS = {
+  // pattern
+  { -0.9999f, 0.3835f, -0.9678f, -0.8802f, 0.2217f, 1.7747f, -0.1794f,
+    0.8268f, -0.6139f, 0.2296f, -0.5650f, -0.6379f, -0.5125f, 1.0373f,
+    -0.0185f, 0.0000f, -0.1847f, -0.2731f, -0.1179f, -0.5339f, 0.5620f,
+    0.4110f, 0.3219f, -0.2088f, -0.0706f, -0.3801f, 0.7315f, 0.3603f,
+    -0.1074f, 0.3209f, 0.5204f, 0.0000f, -0.4522f, 0.3760f, -1.1528f,
+    0.0635f, 0.1978f, 1.5296f, -0.1547f, 0.2438f, -0.2397f, -0.0340f,
+    -0.5762f, 0.2722f, -0.0414f, 0.6388f, 0.7775f, 0.0000f, -0.3653f,
+    -0.3566f, 0.1171f, -1.9533f, -0.1558f, 1.2887f, 0.4378f, -3.7016f,
+    -0.0155f, -0.0066f, 0.6738f, -1.3402f, -3.8441f, -3.2193f, -2.2053f,
+    0.0000f, 0.1302f, -0.1143f, -0.2303f, 0.0178f, -0.3268f, 0.6871f,
+    -0.1825f, -0.0651f, 0.4939f, -0.0516f, 0.5259f, 0.5731f, 0.4367f,
+    0.5759f, 0.3949f, 0.0000f, 0.6958f, -0.1208f, 0.5599f, -0.0319f,
+    0.4717f, 0.0000f, 0.4908f, 0.0000f, 1.1296f, 0.3687f, 1.1826f,
+    0.5573f, 1.5279f, 0.0000f, 1.3401f, 0.0000f, 0.2494f, -0.2985f,
+    -0.2993f, 0.1539f, -0.2122f, 0.8115f, -0.0471f, 0.2333f, 0.0889f,
+    0.1730f, 0.0804f, 0.1441f, 0.5937f, 0.5693f, 0.8521f, 0.0000f,
+    0.2286f, 0.4941f, 0.2079f, -2.3982f, -0.0495f, 0.0000f, -0.2619f,
+    0.0000f, 0.3194f, 0.7996f, 0.7966f, -1.8322f, -2.1265f, 0.0000f,
+    -2.0848f, 0.0000f, -0.2429f, 0.6648f, -0.9845f, -0.0402f, 0.3821f,
+    1.7116f, -0.6833f, 0.7567f, -1.0711f, -0.1778f, -0.2887f, 0.1270f,
+    -1.5262f, 0.7403f, 0.9273f, 0.0000f, -0.2987f, -0.0446f, 0.0547f,
+    -0.4717f, 0.1788f, 0.8693f, 0.1254f, 0.3185f, -0.9056f, -0.3231f,
+    0.0597f, 0.2349f, -0.4778f, 0.4806f, 0.9696f, 0.0000f, -0.3249f,
+    0.2422f, -0.6983f, -0.2255f, 0.4622f, 1.4542f, -0.0871f, 0.7591f,
+    0.0680f, 0.0349f, 1.3477f, 1.3730f, 0.1361f, 1.3440f, 1.1359f,
+    0.0000f, 0.0586f, 0.0109f, 0.5252f, -1.3051f, 0.6601f, 1.2361f,
+    0.5867f, -2.3285f, 0.3259f, 0.4347f, 1.5345f, 0.8960f, -2.4111f,
+    -1.8554f, 1.0782f, 0.0000f, -0.6216f, 0.6387f, 0.0058f, -1.5654f,
+    0.3981f, 1.4815f, 0.4174f, -3.0971f, -1.0064f, -0.2181f, 0.0595f,
+    -0.8268f, -1.5639f, -1.6691f, -0.8853f, 0.0000f, 0.7950f, 0.4851f,
+    0.6138f, -3.3147f, 1.1600f, 0.0000f, 0.9533f, 0.0000f, 0.8327f,
+    1.1412f, 1.0412f, -1.3590f, -1.6969f, 0.0000f, -1.1814f, 0.0000f,
+    0.1724f, 0.4784f, 0.2874f, -0.8147f, 0.8576f, 1.5239f, 1.0193f,
+    -1.4656f, -0.0021f, 0.5696f, 1.3168f, 1.1222f, 0.1642f, -0.0294f,
+    1.3358f, 0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.0000f,
+    0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.0000f,
+    0.0000f, 0.0000f, 0.0000f, 0.0000f},
+  // diagonal
+  { 0.3744f, 0.3009f, -0.1975f, -1.4494f, -1.8367f, 0.3665f, 0.6118f,
+    -0.0987f, -0.2314f, 0.0000f, -0.1527f, 0.0177f, -0.1934f, 0.0000f,
+    0.0000f, -0.9127f, -1.0725f, 0.0000f, 0.0000f, 0.0000f, -1.5035f,
+    0.0000f, 0.0000f, 0.0000f, 0.0000f},
+  // liberties
+  { -3.3132f, -0.7613f, 0.1383f, 1.0133f},
+  // captures
+  { 0.7812f, -1.5530f, -2.3304f, -4.5961f},
+  // gain
+  { 0.0000f, -1.1662f, -0.7886f, 1.2548f, 3.1269f, 4.2161f, 4.1433f,
+    4.7321f},
+  // edge
+  { -0.5979f, 1.2889f, 0.7719f, 0.0000f},
+  // pass
+  0.3225f
+};
@@ -0,0 +1,75 @@
+// Copyright 2019 Chris Solinas
+#include "perft.h"
+
+#include "solver.h"
+
+static long perft_count(Go *game, Color c, int depth, long *moves) {
+  if (depth == 0) return 1;
+  if (game->game_over()) return 0;
+
+  long leaves = 0;
+  Color opp = Go::opponent(c);
+  // walk the empty points straight from the bit board, then try a pass
+  Bitboard empty = game->get_board().empty_points();
+  while (true) {
+    int move = PASS_IND;
+    if (empty) {
+      move = lowest_point(empty);
+      empty &= empty - 1;
+    }
+
+    if (game->make_move(move, c)) {
+      *moves += 1;
+      leaves += perft_count(game, opp, depth - 1, moves);
+      game->undo_move();
+    }
+
+    if (move == PASS_IND) break;
+  }
+
+  return leaves;
+}
+
+long perft(Go *game, Color c, int depth) {
+  long moves = 0;
+  return perft_count(game, c, depth, &moves);
+}
+
+PerftResult perft_divide(Go *game, Color c, int depth) {
+  PerftResult r;
+  Clock::time_point start = Clock::now();
+
+  if (depth > 0 && !game->game_over()) {
+    std::vector<int> moves;
+    game->get_moves(&moves);
+    for (int move : moves) {
+      if (!game->make_move(move, c)) continue;
+      r.moves += 1;
+      long leaves = perft_count(game, Go::opponent(c), depth - 1, &r.moves);
+      game->undo_move();
+      r.divide.push_back(std::make_pair(move, leaves));
+      r.leaves += leaves;
+    }
+  } else if (depth == 0) {
+    r.leaves = 1;
+  }
+
+  auto dur = std::chrono::duration_cast<float_seconds>(Clock::now() - start);
+  r.seconds = dur.count();
+  return r;
+}
+
+void print_perft(const PerftResult& r, int board_size, std::ostream& os) {
+  for (auto& d : r.divide) {
+    os << Board::get_point_coord(d.first, board_size) << " ";
+    os << d.second << "\n";
+  }
+  os << "leaves: " << r.leaves << " moves: " << r.moves;
+  os << " moves/sec: ";
+  if (r.seconds > 0) {
+    os << r.moves / r.seconds;
+  } else {
+    os << "-";
+  }
+  os << "\n";
+}
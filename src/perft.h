@@ -0,0 +1,35 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "Go.h"
+
+/*
+ * Move generation counts ("perft") for Go
+ *
+ * Counts every legal move sequence of a given length from a position, trying
+ * each empty point and a pass at every ply. Legality is whatever
+ * Go::make_move decides, so suicide and positional superko are both checked.
+ * A game that ends with two passes before the requested depth contributes
+ * nothing, the same way checkmate does in chess perft.
+ *
+ * This exercises Board::move, Go::make_move and Go::undo_move without any of
+ * the solver's pruning, so it doubles as a throughput benchmark.
+ * */
+
+struct PerftResult {
+  PerftResult() : leaves(0), moves(0), seconds(0) {}
+  long leaves;  // legal move sequences of the requested length
+  long moves;   // successful make_move calls made while counting
+  float seconds;
+  // leaf count below each legal root move
+  std::vector<std::pair<int, long>> divide;
+};
+
+// number of legal move sequences of length depth with c to move first
+long perft(Go *game, Color c, int depth);
+// perft with per root move counts, timing and total moves made
+PerftResult perft_divide(Go *game, Color c, int depth);
+void print_perft(const PerftResult& r, int board_size, std::ostream& os);
@@ -0,0 +1,288 @@
+// Copyright 2019 Chris Solinas
+#include "position_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include "batch.h"
+
+const char POSITION_MAGIC[8] = {'S', 'G', 'P', 'O', 'S', '0', '0', '1'};
+
+bool PositionRecord::load(Board *b) const {
+  if (size < 2 || size > POSITION_MAX_SIZE || to_move > WHITE) return false;
+  *b = Board(size);
+  Bitboard black = stones[BLACK], white = stones[WHITE];
+  if ((black & ~b->size_mask) || (white & ~b->size_mask) || (black & white)) {
+    return false;
+  }
+  b->set_stones(black, white);
+  return b->legal_position();
+}
+
+bool PositionRecord::setup(Go *game) const {
+  Board b(2);
+  if (!load(&b)) return false;
+  *game = Go(b, passes);
+  const uint64_t *hashes = history();
+  for (int i = 0; i < history_count; i++) game->add_history(hashes[i]);
+  return true;
+}
+
+PositionReader::PositionReader() : fd(-1), data(nullptr), length(0),
+  header(nullptr) {}
+
+PositionReader::~PositionReader() { close(); }
+
+bool PositionReader::open(const std::string& path) {
+  close();
+  fd = ::open(path.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    error = "can't open " + path;
+    close();
+    return false;
+  }
+  length = st.st_size;
+  if (length < sizeof(PositionHeader)) {
+    error = path + " is not a position file";
+    close();
+    return false;
+  }
+  void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapped == MAP_FAILED) {
+    error = "can't map " + path;
+    length = 0;
+    close();
+    return false;
+  }
+  data = static_cast<const char*>(mapped);
+  madvise(mapped, length, MADV_SEQUENTIAL);
+
+  const PositionHeader *h = reinterpret_cast<const PositionHeader*>(data);
+  if (std::memcmp(h->magic, POSITION_MAGIC, sizeof(POSITION_MAGIC)) != 0 ||
+      h->history_slots > 255 ||
+      h->record_size != sizeof(PositionRecord) + 8 * h->history_slots ||
+      (length - sizeof(PositionHeader)) / h->record_size < h->count) {
+    error = path + " is not a position file or is truncated";
+    close();
+    return false;
+  }
+  header = h;
+  return true;
+}
+
+void PositionReader::close() {
+  if (data != nullptr) munmap(const_cast<char*>(data), length);
+  if (fd >= 0) ::close(fd);
+  fd = -1;
+  data = nullptr;
+  length = 0;
+  header = nullptr;
+}
+
+bool PositionReader::is_position_file(const std::string& path) {
+  char magic[sizeof(POSITION_MAGIC)];
+  std::ifstream in(path, std::ios::binary);
+  return in.read(magic, sizeof(magic)) &&
+    std::memcmp(magic, POSITION_MAGIC, sizeof(magic)) == 0;
+}
+
+PositionWriter::PositionWriter() : file(nullptr), slots(0), count(0),
+  failed(false) {}
+
+PositionWriter::~PositionWriter() { close(); }
+
+bool PositionWriter::open(const std::string& path, int history_slots) {
+  close();
+  if (history_slots < 0 || history_slots > 255) {
+    error = "history slots must be between 0 and 255";
+    return false;
+  }
+  file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    error = "can't open " + path;
+    return false;
+  }
+  slots = history_slots;
+  count = 0;
+  failed = false;
+  record.assign(sizeof(PositionRecord) + 8 * slots, 0);
+  // the count is filled in by close
+  PositionHeader header = {};
+  std::memcpy(header.magic, POSITION_MAGIC, sizeof(POSITION_MAGIC));
+  header.history_slots = slots;
+  header.record_size = record.size();
+  if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+    error = "can't write " + path;
+    failed = true;
+  }
+  return !failed;
+}
+
+bool PositionWriter::write(Go *game, Color to_move) {
+  const Board& b = game->get_board();
+  // the position itself is restored with the board, so leave it out
+  std::vector<long> history;
+  for (long hash : game->get_history()) {
+    if (hash != b.h) history.push_back(hash);
+  }
+  return write(b, to_move, game->get_passes(), history);
+}
+
+bool PositionWriter::write(const Board& board, Color to_move, int passes,
+    const std::vector<long>& history) {
+  if (file == nullptr) return false;
+  if (board.n > POSITION_MAX_SIZE) {
+    error = "boards above 8x8 don't fit in a record";
+    return false;
+  }
+  if (history.size() > static_cast<size_t>(slots)) {
+    error = "history needs " + std::to_string(history.size()) + " slots";
+    return false;
+  }
+  std::fill(record.begin(), record.end(), 0);
+  PositionRecord *r = reinterpret_cast<PositionRecord*>(record.data());
+  r->stones[BLACK] = board.stones[BLACK];
+  r->stones[WHITE] = board.stones[WHITE];
+  r->size = board.n;
+  r->to_move = to_move;
+  r->passes = passes > 255 ? 255 : passes;
+  r->history_count = history.size();
+  uint64_t *hashes = reinterpret_cast<uint64_t*>(r + 1);
+  for (size_t i = 0; i < history.size(); i++) hashes[i] = history[i];
+  if (std::fwrite(record.data(), record.size(), 1, file) != 1) {
+    error = "write failed";
+    failed = true;
+    return false;
+  }
+  count++;
+  return true;
+}
+
+bool PositionWriter::close() {
+  if (file == nullptr) return !failed;
+  bool ok = !failed &&
+    std::fseek(file, offsetof(PositionHeader, count), SEEK_SET) == 0 &&
+    std::fwrite(&count, sizeof(count), 1, file) == 1;
+  ok = std::fclose(file) == 0 && ok;
+  file = nullptr;
+  failed = !ok;
+  return ok;
+}
+
+bool read_position_file(const std::string& path,
+    std::vector<BatchPosition> *positions, std::string *error) {
+  PositionReader reader;
+  if (!reader.open(path)) {
+    *error = reader.get_error();
+    return false;
+  }
+  positions->reserve(positions->size() + reader.size());
+  for (size_t i = 0; i < reader.size(); i++) {
+    const PositionRecord& r = reader[i];
+    BatchPosition p;
+    p.line = i + 1;
+    if (r.load(&p.board)) {
+      p.n = r.size;
+      p.to_move = static_cast<Color>(r.to_move);
+      p.passes = r.passes;
+      p.superko.assign(r.history(), r.history() + r.history_count);
+    } else {
+      p.error = "not a legal position";
+    }
+    positions->push_back(p);
+  }
+  return true;
+}
+
+static void read_text_positions(const std::string& path,
+    std::vector<BatchPosition> *positions) {
+  std::ifstream in(path);
+  std::string first;
+  in >> first;
+  in.seekg(0);
+  // batch files start with a board size, GTP scripts with a command
+  if (!first.empty() && std::isdigit(first[0])) {
+    read_batch(in, positions);
+  } else {
+    BatchPosition p;
+    p.line = 1;
+    parse_gtp_script(in, &p);
+    positions->push_back(p);
+  }
+}
+
+int convert_positions(const std::vector<std::string>& inputs,
+    const std::string& output, int history_slots, std::ostream& err) {
+  int failed = 0;
+  bool binary = output.size() > 4 &&
+    output.compare(output.size() - 4, 4, ".pos") == 0;
+
+  if (binary) {
+    PositionWriter writer;
+    if (!writer.open(output, history_slots)) {
+      err << writer.get_error() << "\n";
+      return 1;
+    }
+    for (auto& path : inputs) {
+      if (!std::ifstream(path)) {
+        err << "can't open " << path << "\n";
+        failed++;
+        continue;
+      }
+      std::vector<BatchPosition> positions;
+      read_text_positions(path, &positions);
+      for (auto& p : positions) {
+        Go game(p.n);
+        if (p.error.empty() && !p.setup(&game)) {
+          p.error = "history is illegal or does not reach the board";
+        }
+        if (p.error.empty() && !writer.write(&game, p.to_move)) {
+          p.error = writer.get_error();
+        }
+        if (!p.error.empty()) {
+          err << path << ":" << p.line << ": " << p.error << "\n";
+          failed++;
+        }
+      }
+    }
+    if (!writer.close()) {
+      err << "can't write " << output << "\n";
+      failed++;
+    }
+    return failed;
+  }
+
+  std::ofstream out(output);
+  if (!out) {
+    err << "can't open " << output << "\n";
+    return 1;
+  }
+  PositionReader reader;
+  BatchPosition p;
+  for (auto& path : inputs) {
+    if (!reader.open(path)) {
+      err << reader.get_error() << "\n";
+      failed++;
+      continue;
+    }
+    for (size_t i = 0; i < reader.size(); i++) {
+      const PositionRecord& r = reader[i];
+      if (!r.load(&p.board)) {
+        err << path << ":" << i + 1 << ": not a legal position\n";
+        failed++;
+        continue;
+      }
+      p.n = r.size;
+      p.to_move = static_cast<Color>(r.to_move);
+      out << format_batch_position(p) << "\n";
+    }
+  }
+  return failed;
+}
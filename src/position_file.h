@@ -0,0 +1,124 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Go.h"
+#include "batch.h"
+
+/*
+ * Binary files of positions with fixed width records
+ *
+ * A file is a header followed by records that all have the same size:
+ *
+ *   header: "SGPOS001", history slots (u32), record size (u32), count (u64)
+ *   record: black stones (u64), white stones (u64), size (u8),
+ *           side to move (u8), passes (u8), history count (u8), 4 zero
+ *           bytes, then history slots superko hashes (u64)
+ *
+ * The hashes are the Zobrist hashes of earlier positions that may not be
+ * repeated, not counting the position itself. A file written with 0 history
+ * slots has 24 byte records. Values are stored in the machine's byte order
+ * and the hashes are only meaningful to builds with the same Zobrist keys.
+ *
+ * The reader maps the whole file into memory, so records are read in place
+ * and loading one into a Board allocates nothing.
+ * */
+
+struct PositionHeader {
+  char magic[8];
+  uint32_t history_slots;
+  uint32_t record_size;
+  uint64_t count;
+};
+
+struct PositionRecord {
+  uint64_t stones[2];
+  uint8_t size;
+  uint8_t to_move;
+  uint8_t passes;
+  uint8_t history_count;
+  uint32_t reserved;
+
+  // the superko hashes that follow the record
+  const uint64_t* history() const {
+    return reinterpret_cast<const uint64_t*>(this + 1);
+  }
+  // false if the record doesn't hold a legal position
+  bool load(Board *b) const;
+  // also restores the passes and superko history
+  bool setup(Go *game) const;
+};
+
+static_assert(sizeof(PositionHeader) == 24, "header must be packed");
+static_assert(sizeof(PositionRecord) == 24, "record must be packed");
+
+extern const char POSITION_MAGIC[8];
+// history slots the converter uses unless told otherwise
+constexpr int DEFAULT_HISTORY_SLOTS = 16;
+// the stones of larger boards don't fit in 64 bits
+constexpr int POSITION_MAX_SIZE = 8;
+
+class PositionReader {
+  int fd;
+  const char *data;
+  size_t length;
+  const PositionHeader *header;
+  std::string error;
+
+ public:
+  PositionReader();
+  ~PositionReader();
+  PositionReader(const PositionReader&) = delete;
+  PositionReader& operator=(const PositionReader&) = delete;
+
+  // map the file, false if it isn't a position file
+  bool open(const std::string& path);
+  void close();
+  size_t size() const { return header ? header->count : 0; }
+  int history_slots() const { return header ? header->history_slots : 0; }
+  const PositionRecord& operator[](size_t i) const {
+    return *reinterpret_cast<const PositionRecord*>(
+        data + sizeof(PositionHeader) + i * header->record_size);
+  }
+  const std::string& get_error() const { return error; }
+  // true if path starts with the position file magic
+  static bool is_position_file(const std::string& path);
+};
+
+class PositionWriter {
+  FILE *file;
+  int slots;
+  uint64_t count;
+  std::vector<char> record;
+  bool failed;  // a write to the file failed
+  std::string error;
+
+ public:
+  PositionWriter();
+  ~PositionWriter();
+  PositionWriter(const PositionWriter&) = delete;
+  PositionWriter& operator=(const PositionWriter&) = delete;
+
+  bool open(const std::string& path, int history_slots);
+  // false if the game's superko history doesn't fit in the history slots
+  bool write(Go *game, Color to_move);
+  bool write(const Board& board, Color to_move, int passes,
+      const std::vector<long>& history);
+  // fill in the record count, false if writing to the file failed
+  bool close();
+  uint64_t written() const { return count; }
+  const std::string& get_error() const { return error; }
+};
+
+// every record of a position file as batch positions, for run_batch
+bool read_position_file(const std::string& path,
+    std::vector<BatchPosition> *positions, std::string *error);
+// convert GTP scripts or batch files to a position file, or position files
+// to batch lines, depending on whether output ends in ".pos". Returns the
+// number of positions that could not be converted.
+int convert_positions(const std::vector<std::string>& inputs,
+    const std::string& output, int history_slots, std::ostream& err);
@@ -0,0 +1,46 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <cstdint>
+#include "board.h"
+
+/*
+ * Small, fast generator for random playouts and games (xorshift64*)
+ *
+ * Not thread safe, every thread is expected to own its own generator. It can
+ * also run at compile time to fill constant tables.
+ * */
+class Random {
+  uint64_t state = 1;
+
+ public:
+  constexpr explicit Random(uint64_t seed) { set_seed(seed); }
+
+  constexpr void set_seed(uint64_t seed) {
+    // splitmix the seed so that small or similar seeds give unrelated streams
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    state = z ^ (z >> 31);
+    if (state == 0) state = 1;
+  }
+
+  constexpr uint64_t next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+  }
+
+  // uniform value in [0, bound)
+  uint32_t below(uint32_t bound) {
+    return static_cast<uint32_t>(((next() >> 32) * bound) >> 32);
+  }
+
+  // index of a uniformly chosen set bit of a non-empty mask
+  int choose_bit(Bitboard mask) {
+    int k = below(bit_count(mask));
+    for (int i = 0; i < k; i++) mask &= mask - 1;
+    return lowest_point(mask);
+  }
+};
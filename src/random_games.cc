@@ -0,0 +1,192 @@
+// Copyright 2019 Chris Solinas
+#include "random_games.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include "solver.h"
+
+const char GAME_MAGIC[8] = {'S', 'G', 'G', 'A', 'M', '0', '0', '1'};
+
+void play_random_game(int n, bool eye_aware, Random *rng, RandomGame *game) {
+  Board b(n);
+  // hashes of every position so far, a game is too short for a set to pay
+  long history[RANDOM_GAME_MAX_MOVES(MAX_BOARD_SIZE)];
+  int positions = 0;
+  int passes = 0;
+  Color c = BLACK;
+  int max_moves = RANDOM_GAME_MAX_MOVES(n);
+  game->n = n;
+  game->moves.clear();
+  while (passes < 2 && static_cast<int>(game->moves.size()) < max_moves) {
+    Bitboard candidates = b.empty_points();
+    if (eye_aware) candidates &= ~b.eyes(c);
+    int move = PASS_IND;
+    while (candidates) {
+      int point = rng->choose_bit(candidates);
+      candidates &= ~point_bit(point);
+      Board next(b);
+      // suicide or a repeated position, try another point
+      if (!next.move(point, c)) continue;
+      if (std::find(history, history + positions, next.h) !=
+          history + positions) {
+        continue;
+      }
+      b = next;
+      history[positions++] = b.h;
+      move = point;
+      break;
+    }
+    passes = move == PASS_IND ? passes + 1 : 0;
+    game->moves.push_back(move);
+    c = Board::opponent(c);
+  }
+  game->score = b.score(BLACK);
+  game->finished = passes == 2;
+}
+
+void encode_game(const RandomGame& game, std::string *out) {
+  GameRecordHeader h;
+  h.size = game.n;
+  h.moves = game.moves.size();
+  h.score = static_cast<int8_t>(game.score);
+  h.flags = game.finished ? GAME_FINISHED : 0;
+  out->append(reinterpret_cast<const char*>(&h), sizeof(h));
+  for (int move : game.moves) {
+    out->push_back(static_cast<char>(move == PASS_IND ? GAME_PASS : move));
+  }
+}
+
+GeneratorResult generate_games(int n, long count, bool eye_aware,
+    uint64_t seed, int threads, const std::string& path) {
+  GeneratorResult result;
+  if (n < 2 || n > MAX_BOARD_SIZE) {
+    result.error = "board size must be between 2 and " +
+      std::to_string(MAX_BOARD_SIZE);
+    return result;
+  }
+  FILE *file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    result.error = "can't open " + path;
+    return result;
+  }
+  GameFileHeader header;
+  std::memcpy(header.magic, GAME_MAGIC, sizeof(header.magic));
+  header.count = 0;
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+  Clock::time_point start = Clock::now();
+  long blocks = (count + RANDOM_GAME_BLOCK - 1) / RANDOM_GAME_BLOCK;
+  std::vector<std::string> encoded(blocks);
+  std::vector<char> done(blocks, 0);
+  std::mutex lock;
+  std::condition_variable finished;
+  std::atomic<long> next(0);
+  std::atomic<long> moves(0);
+
+  auto work = [&]() {
+    RandomGame game;
+    long played = 0;
+    for (long block = next++; block < blocks; block = next++) {
+      Random rng(seed ^ (block * 0x9E3779B97F4A7C15ULL));
+      long games = std::min<long>(RANDOM_GAME_BLOCK,
+          count - block * RANDOM_GAME_BLOCK);
+      std::string out;
+      for (long i = 0; i < games; i++) {
+        play_random_game(n, eye_aware, &rng, &game);
+        encode_game(game, &out);
+        played += game.moves.size();
+      }
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        encoded[block].swap(out);
+        done[block] = 1;
+      }
+      finished.notify_all();
+    }
+    moves += played;
+  };
+
+  if (threads < 1) threads = 1;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) workers.emplace_back(work);
+
+  // write blocks in order as soon as they are played
+  for (long block = 0; block < blocks; block++) {
+    std::string out;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      finished.wait(guard, [&]() { return done[block] != 0; });
+      out.swap(encoded[block]);
+    }
+    if (ok) ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+  }
+  for (auto& w : workers) w.join();
+
+  header.count = count;
+  ok = ok && std::fseek(file, 0, SEEK_SET) == 0 &&
+    std::fwrite(&header, sizeof(header), 1, file) == 1;
+  ok = std::fclose(file) == 0 && ok;
+  auto dur = std::chrono::duration_cast<float_seconds>(Clock::now() - start);
+  result.seconds = dur.count();
+  result.moves = moves;
+  if (ok) {
+    result.games = count;
+  } else {
+    result.error = "can't write " + path;
+  }
+  return result;
+}
+
+bool read_game_file(const std::string& path, std::vector<RandomGame> *games,
+    std::string *error) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    *error = "can't open " + path;
+    return false;
+  }
+  std::string data((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+  GameFileHeader header;
+  if (data.size() < sizeof(header) ||
+      std::memcmp(data.data(), GAME_MAGIC, sizeof(GAME_MAGIC)) != 0) {
+    *error = path + " is not a game file";
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  size_t at = sizeof(header);
+  for (uint64_t i = 0; i < header.count; i++) {
+    GameRecordHeader h;
+    if (data.size() - at < sizeof(h)) break;
+    std::memcpy(&h, data.data() + at, sizeof(h));
+    at += sizeof(h);
+    if (h.size < 2 || h.size > MAX_BOARD_SIZE || data.size() - at < h.moves) {
+      break;
+    }
+    RandomGame game;
+    game.n = h.size;
+    game.score = h.score;
+    game.finished = h.flags & GAME_FINISHED;
+    for (int j = 0; j < h.moves; j++) {
+      uint8_t move = data[at + j];
+      if (move != GAME_PASS && move >= h.size * h.size) break;
+      game.moves.push_back(move == GAME_PASS ? PASS_IND : move);
+    }
+    if (game.moves.size() != h.moves) break;
+    at += h.moves;
+    games->push_back(game);
+  }
+  if (games->size() != header.count || at != data.size()) {
+    *error = path + " is truncated or corrupt after game " +
+      std::to_string(games->size());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,85 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Go.h"
+#include "random.h"
+
+/*
+ * Random legal games for test and training corpora
+ *
+ * Games are played straight on the bit board. A move is a uniformly chosen
+ * empty point that is legal under suicide and positional superko, the same
+ * rules Go::make_move enforces, and a player only passes when it has no such
+ * point. Eye aware games also leave out points whose neighbors are all the
+ * player's own stones, like MCTS playouts do, so they end with both sides
+ * passing instead of filling their own eyes. Games stop after
+ * RANDOM_GAME_MAX_MOVES(n) moves either way.
+ *
+ * Games are written to a binary stream:
+ *
+ *   header: "SGGAM001", count (u64)
+ *   game:   size (u8), moves (u8), black's score (i8), flags (u8), then one
+ *           byte per move with the point index or 255 for a pass
+ *
+ * Black always moves first from the empty board. The only flag is
+ * GAME_FINISHED, set when the game ended with two passes.
+ *
+ * Every block of RANDOM_GAME_BLOCK games has its own generator seeded from
+ * the seed and the block number, so the output only depends on the seed and
+ * not on how many threads play the games.
+ * */
+
+constexpr int RANDOM_GAME_BLOCK = 4096;
+constexpr uint8_t GAME_PASS = 255;
+constexpr uint8_t GAME_FINISHED = 1;
+
+// at most 255 so the length fits in a byte
+constexpr int RANDOM_GAME_MAX_MOVES(int n) {
+  return 3 * n * n < 255 ? 3 * n * n : 255;
+}
+
+struct GameFileHeader {
+  char magic[8];
+  uint64_t count;
+};
+
+struct GameRecordHeader {
+  uint8_t size;
+  uint8_t moves;
+  int8_t score;
+  uint8_t flags;
+};
+
+static_assert(sizeof(GameFileHeader) == 16, "header must be packed");
+static_assert(sizeof(GameRecordHeader) == 4, "record must be packed");
+
+extern const char GAME_MAGIC[8];
+
+struct RandomGame {
+  int n;
+  std::vector<int> moves;  // point indices or PASS_IND, black first
+  float score;  // for black
+  bool finished;
+};
+
+struct GeneratorResult {
+  GeneratorResult() : games(0), moves(0), seconds(0) {}
+  long games;
+  long moves;
+  float seconds;
+  std::string error;  // empty if every game was written
+};
+
+// play one random game on an empty board of size n
+void play_random_game(int n, bool eye_aware, Random *rng, RandomGame *game);
+// append the game's record to *out
+void encode_game(const RandomGame& game, std::string *out);
+// play count games on threads and write them to path
+GeneratorResult generate_games(int n, long count, bool eye_aware,
+    uint64_t seed, int threads, const std::string& path);
+// every game of a file written by generate_games
+bool read_game_file(const std::string& path, std::vector<RandomGame> *games,
+    std::string *error);
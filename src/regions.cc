@@ -0,0 +1,81 @@
+// Copyright 2019 Chris Solinas
+#include "regions.h"
+
+#include <algorithm>
+#include "Go.h"
+
+int find_regions(const Board& b, Bitboard settled, Bitboard *regions,
+    int max_regions) {
+  Bitboard rest = b.size_mask & ~settled;
+  int count = 0;
+  while (rest) {
+    if (count == max_regions) return -1;
+    Bitboard region = rest & -rest, prev = 0;
+    while (region != prev) {
+      prev = region;
+      region |= b.adjacent(region) & rest;
+    }
+    regions[count++] = region;
+    rest &= ~region;
+  }
+  return count;
+}
+
+float LocalSolver::score(const Board& b, Bitboard region) {
+  int black = bit_count(b.stones[BLACK] & region);
+  int white = bit_count(b.stones[WHITE] & region);
+  Bitboard empty = b.empty_points() & region;
+  black += bit_count(empty & b.eyes(BLACK));
+  white += bit_count(empty & b.eyes(WHITE));
+  return black - white;
+}
+
+LocalValue LocalSolver::solve(const Board& b, Bitboard region) {
+  Bitboard around = region | b.adjacent(region);
+  Key key = {region, b.stones[BLACK] & around, b.stones[WHITE] & around};
+  Entry& e = cache[slot(key)];
+  if (e.used && e.key == key) return e.value;
+
+  LocalValue v = {0, 0, false};
+  if (bit_count(b.empty_points() & region) <= REGION_MAX_EMPTY) {
+    float bound = bit_count(region);
+    nodes = 0;
+    history[0] = b.h;
+    history_size = 1;
+    v.black_first = search(b, region, BLACK, 0, -bound, bound);
+    v.white_first = -search(b, region, WHITE, 0, -bound, bound);
+    v.solved = nodes <= REGION_MAX_NODES;
+  }
+  e = {key, v, true};
+  return v;
+}
+
+float LocalSolver::search(const Board& b, Bitboard region, Color c,
+    int passes, float alpha, float beta) {
+  float sign = c == BLACK ? 1 : -1;
+  if (passes == 2) return sign * score(b, region);
+  if (++nodes > REGION_MAX_NODES) return 0;
+  if (history_size > REGION_MAX_DEPTH) {
+    // gives up on the region the same way running out of nodes does
+    nodes = REGION_MAX_NODES + 1;
+    return 0;
+  }
+
+  Color opp = Go::opponent(c);
+  // passing first, there's nothing else to do in most small regions
+  float best = -search(b, region, opp, passes + 1, -beta, -alpha);
+  alpha = std::max(alpha, best);
+  for (Bitboard moves = b.empty_points() & region & ~b.eyes(c);
+      moves && alpha < beta; moves &= moves - 1) {
+    Board next(b);
+    if (!next.move(lowest_point(moves), c)) continue;
+    long *end = history + history_size;
+    if (std::find(history, end, next.h) != end) continue;
+    history[history_size++] = next.h;
+    float value = -search(next, region, opp, 0, -beta, -alpha);
+    history_size--;
+    best = std::max(best, value);
+    alpha = std::max(alpha, value);
+  }
+  return best;
+}
@@ -0,0 +1,97 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "board.h"
+
+/*
+ * Independent regions of a board split up by settled points
+ *
+ * Settled points (see Board::settled) never change hands, so the rest of the
+ * board falls apart into regions that only touch each other through settled
+ * stones. A move in one region can't capture or change the liberties of
+ * anything in another, and the final score is the settled points plus a sum
+ * over the regions.
+ *
+ * LocalSolver plays out one region on its own, with everything else fixed
+ * and passes allowed, for each color moving first. A region is cold when
+ * both give the same value: neither side gains by moving there first. When
+ * every region is cold, the board is worth the settled points plus the
+ * region values whoever is to move, so the solver can score it without
+ * searching the product of all regions' moves.
+ *
+ * Local searches only know the superko history of their own region, the same
+ * way transposition table results don't depend on how a position was
+ * reached.
+ * */
+
+// regions with more empty points than this aren't solved locally
+constexpr int REGION_MAX_EMPTY = 6;
+constexpr long REGION_MAX_NODES = 1 << 16;
+// longer local games leave the region unsolved
+constexpr int REGION_MAX_DEPTH = 32;
+// the cache of region values has 2^bits slots, this many by default, and a
+// newer value replaces an older one in the same slot
+constexpr int REGION_CACHE_BITS = 16;
+
+// split the points outside of settled into connected regions, returns how
+// many there are or -1 if there are more than max_regions
+int find_regions(const Board& b, Bitboard settled, Bitboard *regions,
+    int max_regions);
+
+struct LocalValue {
+  float black_first;  // black's score in the region when black moves first
+  float white_first;
+  bool solved;  // false if the region was too large to solve
+
+  bool cold() const { return solved && black_first == white_first; }
+};
+
+class LocalSolver {
+  struct Key {
+    Bitboard region, black, white;
+    bool operator==(const Key& k) const {
+      return region == k.region && black == k.black && white == k.white;
+    }
+  };
+  struct Entry {
+    Key key;
+    LocalValue value;
+    bool used;
+  };
+  // allocated once like the transposition table, so solving doesn't
+  std::vector<Entry> cache;
+  int bits;
+  // positions played in the current search
+  long history[REGION_MAX_DEPTH + 1];
+  int history_size;
+  long nodes;
+
+  // the top bits of the products depend on every point
+  size_t slot(const Key& k) const {
+    return static_cast<uint64_t>(k.region * 0x9E3779B97F4A7C15UL ^
+        k.black * 0xBF58476D1CE4E5B9UL ^ k.white * 0x94D049BB133111EBUL) >>
+      (64 - bits);
+  }
+  float search(const Board& b, Bitboard region, Color c, int passes,
+      float alpha, float beta);
+
+ public:
+  // a cache of 2^_bits values, at least 2
+  explicit LocalSolver(int _bits = REGION_CACHE_BITS) :
+    cache(1L << std::max(_bits, 1)), bits(std::max(_bits, 1)),
+    history_size(0), nodes(0) {
+    clear();
+  }
+  // the region's value with each color to move first, cached by the stones
+  // in and around it
+  LocalValue solve(const Board& b, Bitboard region);
+  // black's points in region: its stones and the empty points next to only
+  // black stones, less the same for white
+  static float score(const Board& b, Bitboard region);
+  void clear() {
+    for (Entry& e : cache) e.used = false;
+  }
+};
@@ -0,0 +1,110 @@
+// Copyright 2019 Chris Solinas
+#include "search_stats.h"
+
+#include <algorithm>
+
+void SearchStats::reset() {
+  tt_probes = 0;
+  tt_hits = 0;
+  cutoffs = 0;
+  first_move_cutoffs = 0;
+  superko_rejections = 0;
+  eye_fill_skips = 0;
+  safety_cutoffs = 0;
+  region_cutoffs = 0;
+  etc_cutoffs = 0;
+  pvs_researches = 0;
+  std::fill(nodes_by_depth, nodes_by_depth + STATS_DEPTHS, 0);
+  std::fill(theorem_hits_by_depth, theorem_hits_by_depth + STATS_DEPTHS, 0);
+  iterations.clear();
+}
+
+long SearchStats::nodes() const {
+  long total = 0;
+  for (int d = 0; d < STATS_DEPTHS; d++) total += nodes_by_depth[d];
+  return total;
+}
+
+float SearchStats::first_move_cutoff_rate() const {
+  if (cutoffs == 0) return 0;
+  return 1.0 * first_move_cutoffs / cutoffs;
+}
+
+float SearchStats::branching_factor(int d) const {
+  if (d + 1 >= STATS_DEPTHS || nodes_by_depth[d] == 0) return 0;
+  return 1.0 * nodes_by_depth[d + 1] / nodes_by_depth[d];
+}
+
+int SearchStats::deepest() const {
+  int deepest = -1;
+  for (int d = 0; d < STATS_DEPTHS; d++) {
+    if (nodes_by_depth[d] || theorem_hits_by_depth[d]) deepest = d;
+  }
+  return deepest;
+}
+
+void SearchStats::print(std::ostream& os) const {
+#ifndef SEARCH_STATS
+  os << "search stats disabled at compile time\n";
+#else
+  os << "nodes: " << nodes() << "\n";
+  os << "tt probes: " << tt_probes << " hits: " << tt_hits << "\n";
+  os << "cutoffs: " << cutoffs << " first move: " << first_move_cutoff_rate();
+  os << "\n";
+  os << "superko rejections: " << superko_rejections << "\n";
+  os << "eye fill skips: " << eye_fill_skips << "\n";
+  os << "safety cutoffs: " << safety_cutoffs << "\n";
+  os << "region cutoffs: " << region_cutoffs << "\n";
+  os << "etc cutoffs: " << etc_cutoffs << "\n";
+  os << "pvs re-searches: " << pvs_researches << "\n";
+  os << "depth nodes ebf theorem_hits\n";
+  int deepest = this->deepest();
+  for (int d = 0; d <= deepest; d++) {
+    os << d << " " << nodes_by_depth[d] << " " << branching_factor(d);
+    os << " " << theorem_hits_by_depth[d] << "\n";
+  }
+  os << "iteration nodes seconds\n";
+  for (auto& it : iterations) {
+    os << it.max_depth << " " << it.nodes << " " << it.seconds << "\n";
+  }
+#endif
+}
+
+void SearchStats::to_json(std::ostream& os) const {
+#ifndef SEARCH_STATS
+  os << "{\"enabled\":false}";
+#else
+  int deepest = this->deepest();
+  os << "{\"enabled\":true";
+  os << ",\"nodes\":" << nodes();
+  os << ",\"tt_probes\":" << tt_probes;
+  os << ",\"tt_hits\":" << tt_hits;
+  os << ",\"cutoffs\":" << cutoffs;
+  os << ",\"first_move_cutoffs\":" << first_move_cutoffs;
+  os << ",\"superko_rejections\":" << superko_rejections;
+  os << ",\"eye_fill_skips\":" << eye_fill_skips;
+  os << ",\"safety_cutoffs\":" << safety_cutoffs;
+  os << ",\"region_cutoffs\":" << region_cutoffs;
+  os << ",\"etc_cutoffs\":" << etc_cutoffs;
+  os << ",\"pvs_researches\":" << pvs_researches;
+  os << ",\"nodes_by_depth\":[";
+  for (int d = 0; d <= deepest; d++) {
+    os << (d ? "," : "") << nodes_by_depth[d];
+  }
+  os << "],\"branching_factor\":[";
+  for (int d = 0; d <= deepest; d++) {
+    os << (d ? "," : "") << branching_factor(d);
+  }
+  os << "],\"theorem_hits_by_depth\":[";
+  for (int d = 0; d <= deepest; d++) {
+    os << (d ? "," : "") << theorem_hits_by_depth[d];
+  }
+  os << "],\"iterations\":[";
+  for (size_t i = 0; i < iterations.size(); i++) {
+    const IterationStats& it = iterations[i];
+    os << (i ? "," : "") << "{\"max_depth\":" << it.max_depth;
+    os << ",\"nodes\":" << it.nodes << ",\"seconds\":" << it.seconds << "}";
+  }
+  os << "]}";
+#endif
+}
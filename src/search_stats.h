@@ -0,0 +1,66 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include "Go.h"
+
+/*
+ * Counters describing what the solver did during its last search
+ *
+ * Collection is on by default. Building with -DNO_SEARCH_STATS compiles every
+ * STATS(...) statement out of the search. Each Solver owns its own counters
+ * and a Solver is only ever used by one thread at a time, so the counters are
+ * plain integers with no atomics or locking on the hot path.
+ * */
+
+#ifdef NO_SEARCH_STATS
+#define STATS(x)
+#else
+#define SEARCH_STATS
+#define STATS(x) x
+#endif
+
+constexpr int STATS_DEPTHS = MAX_DEPTH + 1;
+
+struct IterationStats {
+  int max_depth;
+  long nodes;
+  float seconds;
+};
+
+struct SearchStats {
+  SearchStats() { reset(); }
+
+  long tt_probes;
+  long tt_hits;
+  long cutoffs;
+  long first_move_cutoffs;  // cutoffs caused by the first legal move tried
+  long superko_rejections;
+  long eye_fill_skips;
+  // nodes cut off by the score bounds of stones that can't be captured
+  long safety_cutoffs;
+  // nodes scored by summing cold regions
+  long region_cutoffs;
+  // nodes cut off by a child's stored bound before any move was made
+  long etc_cutoffs;
+  // null window searches that beat alpha and were searched again
+  long pvs_researches;
+  long nodes_by_depth[STATS_DEPTHS];
+  long theorem_hits_by_depth[STATS_DEPTHS];
+  std::vector<IterationStats> iterations;
+
+  void reset();
+  static int depth_index(int d) { return d < MAX_DEPTH ? d : MAX_DEPTH; }
+
+  long nodes() const;
+  // fraction of cutoffs found on the first move searched
+  float first_move_cutoff_rate() const;
+  // ratio of nodes at depth d + 1 to nodes at depth d, 0 if there are none
+  float branching_factor(int d) const;
+  // deepest ply that recorded any node
+  int deepest() const;
+
+  void print(std::ostream& os) const;
+  void to_json(std::ostream& os) const;
+};
@@ -3,7 +3,69 @@
 #include <iostream>
 #include <algorithm>
 
-Solver::Solver() : nodes(0), verbose(true) { init_theorems_3x3(); }
+Solver::Solver() : Solver(true) {}
+
+Solver::Solver(bool _verbose, int table_bits) : nodes(0),
+  verbose(_verbose), safety_pruning(true), pvs(true),
+  decomposition(true), etc(true), ordering(&tuned_ordering()), samples(nullptr),
+  theorems_3x3(TheoremTable3x3::get()),
+  theorem_hits(theorems_3x3.size(), 0), TT(table_bits),
+  regions(table_bits - TT_BITS + REGION_CACHE_BITS),
+  superko_rejects(0), root_history(0), stopping(false), info(nullptr),
+  next_info(0), proven_depth(0), pv_depth(0), move_lists(MAX_DEPTH) {
+  std::fill(killer_table, killer_table + MAX_DEPTH, UNDEFINED);
+  // everything a search keeps growing gets room for the longest one up
+  // front, so solving doesn't allocate
+  for (auto& moves : move_lists) moves.reserve(MAX_POINTS + 1);
+  last_pv.reserve(MAX_DEPTH);
+  pv_keys.reserve(MAX_DEPTH + 1);
+  expected_pv.reserve(MAX_DEPTH);
+  stats.iterations.reserve(MAX_DEPTH);
+}
+
+Solver::~Solver() {}
+
+void Solver::clear() {
+  TT.clear();
+  regions.clear();
+  std::fill(killer_table, killer_table + MAX_DEPTH, UNDEFINED);
+  last_pv.clear();
+  pv_keys.clear();
+  proven_depth = 0;
+}
+
+int Solver::resume(Go *game, Color c) {
+  long root = TranspositionTable::key(game->get_board(), c,
+      game->last_move_was_pass());
+  expected_pv.clear();
+  for (size_t i = 0; i < pv_keys.size(); i++) {
+    if (pv_keys[i] != root) continue;
+    expected_pv.assign(last_pv.begin() + i, last_pv.end());
+    // killer moves are kept per ply from the root
+    std::copy(killer_table + i, killer_table + MAX_DEPTH, killer_table);
+    std::fill(killer_table + MAX_DEPTH - i, killer_table + MAX_DEPTH,
+        UNDEFINED);
+    return i;
+  }
+  return -1;
+}
+
+void Solver::remember_pv(Go *game, Color c, const Result& r, int max_depth) {
+  last_pv.clear();
+  pv_keys.clear();
+  proven_depth = max_depth;
+  pv_keys.push_back(TranspositionTable::key(game->get_board(), c,
+        game->last_move_was_pass()));
+  // replay the pv to find the positions it expects
+  for (int move : r.pv) {
+    if (move == UNDEFINED || !game->make_move(move, c)) break;
+    c = Go::opponent(c);
+    last_pv.push_back(move);
+    pv_keys.push_back(TranspositionTable::key(game->get_board(), c,
+          game->last_move_was_pass()));
+  }
+  for (size_t i = 0; i < last_pv.size(); i++) game->undo_move();
+}
 
 int Solver::solve(Go *game, Color c) {
   int max_score = game->size() * game->size();
@@ -14,19 +76,123 @@ int Solver::solve(Go *game, Color c, int max_score) {
   nodes = 0;
   start = Clock::now();
   int max_depth = 0;
+  STATS(stats.reset());
+  root_history = 0;
+  for (long h : game->get_history()) root_history ^= h * 0x2545F4914F6CDD1DL;
+
+  // a root reached by following the last pv needs about as many fewer
+  // plies to prove as have been played since
+  int played = resume(game, c);
+  if (played >= 0) max_depth = std::max(0, proven_depth - played - 1);
 
   Result r;
+  provisional.reset();
+  next_info = INFO_SECONDS;
 
-  while (r.is_undefined()) {
-    TT.clear();
+  // at least one pass over the root moves, so a stopped solve still has a
+  // legal move to return
+  do {
+    pv_depth = 0;
     std::fill(theorem_hits.begin(), theorem_hits.end(), 0);
+    STATS(long iteration_nodes = nodes);
+    STATS(Clock::time_point iteration_start = Clock::now());
     r = alpha_beta(game, c, -1.0 * max_score, 1.0 * max_score, 0, ++max_depth);
     r.pv.push_front(r.best_move);
+    STATS(stats.iterations.push_back({max_depth, nodes - iteration_nodes,
+          std::chrono::duration_cast<float_seconds>(
+            Clock::now() - iteration_start).count()}));
     if (verbose) {
       display_results(r, max_depth, game->size());
     }
+    if (info != nullptr) print_info(r, max_depth, game->size(), false);
+  } while (r.is_undefined() && !stopping);
+  if (!r.is_undefined()) remember_pv(game, c, r, max_depth);
+  last = r;
+  return r.is_undefined() ? provisional.best_move : r.best_move;
+}
+
+bool Solver::decompose(const Board& b, Color c, float *value) {
+  Bitboard black = b.settled(BLACK), white = b.settled(WHITE);
+  if (!(black | white)) return false;
+  Bitboard parts[MAX_POINTS];
+  int count = find_regions(b, black | white, parts, MAX_POINTS);
+  float sum = bit_count(black) - bit_count(white);
+  for (int i = 0; i < count; i++) {
+    LocalValue v = regions.solve(b, parts[i]);
+    if (!v.cold()) return false;
+    sum += v.black_first;
+  }
+  *value = c == BLACK ? sum : -sum;
+  return true;
+}
+
+void Solver::order_moves(const Board& b, Color c, int killer,
+    std::vector<int> *moves) {
+  // keys and board order on the stack, ties keep board order
+  std::pair<float, int> keyed[MAX_POINTS + 1];
+  int unsorted[MAX_POINTS + 1];
+  int count = moves->size();
+  for (int i = 0; i < count; i++) {
+    int move = (*moves)[i];
+    MoveFeatures f;
+    float key = -MAX_VAL;
+    if (move_features(b, move, c, &f)) {
+      key = move == killer ? MAX_VAL : ordering_score(*ordering, f);
+    }
+    keyed[i] = std::make_pair(key, i);
+    unsorted[i] = move;
+  }
+  std::sort(keyed, keyed + count,
+      [](const std::pair<float, int>& l, const std::pair<float, int>& r) {
+        return l.first > r.first ||
+          (l.first == r.first && l.second < r.second);
+      });
+  for (int i = 0; i < count; i++) (*moves)[i] = unsorted[keyed[i].second];
+}
+
+void Solver::record_sample(const Board& b, Color c,
+    const std::vector<int>& moves, int best_move) {
+  OrderingSample s;
+  s.best = -1;
+  for (int move : moves) {
+    MoveFeatures f;
+    if (move >= 0 && b.fills_eye(move, c)) continue;
+    if (!move_features(b, move, c, &f)) continue;
+    if (move == best_move) s.best = s.moves.size();
+    s.moves.push_back(f);
+  }
+  if (s.best >= 0 && s.moves.size() > 1) samples->push_back(s);
+}
+
+bool Solver::transposition_cutoff(Go *game, Color c, float beta, Result *r) {
+  const Board& b = game->get_board();
+  Color opp = Go::opponent(c);
+  // every key is computed and its slot prefetched before the first probe,
+  // so the loads overlap instead of waiting on each other
+  long keys[MAX_POINTS];
+  int moves[MAX_POINTS];
+  int count = 0;
+  for (Bitboard rest = b.empty_points(); rest; rest &= rest - 1) {
+    int move = lowest_point(rest);
+    long h;
+    if (b.fills_eye(move, c) || !b.hash_after(move, c, &h)) continue;
+    if (game->repeats(h)) continue;
+    keys[count] = TranspositionTable::key(h, b.n, opp, false);
+    TT.prefetch(keys[count]);
+    moves[count++] = move;
+  }
+  // a child's exact value or upper bound v means this node is worth at
+  // least -v
+  for (int i = 0; i < count; i++) {
+    const TT_entry *e = TT.probe(keys[i]);
+    if (e != nullptr && e->bound != LOWER_BOUND && -1 * e->value >= beta) {
+      r->value = -1 * e->value;
+      r->best_move = moves[i];
+      r->terminal = true;
+      return true;
+    }
   }
-  return r.best_move;
+  return false;
 }
 
 Result Solver::alpha_beta(Go *game, Color c, float alpha, float beta, int d,
@@ -34,6 +200,7 @@ Result Solver::alpha_beta(Go *game, Color c, float alpha, float beta, int d,
 
   Result best;
   if (d > max_depth) return best;
+  if (d > 0 && stopping.load(std::memory_order_relaxed)) return best;
 
   if (game->game_over() || (MAX_NODES > 0 && nodes > MAX_NODES)) {
     best.value = game->score(c);
@@ -41,41 +208,155 @@ Result Solver::alpha_beta(Go *game, Color c, float alpha, float beta, int d,
     return best;
   }
 
-  if (game->size() == 3) {
-    for (size_t i = 0; i < theorems_3x3.size(); i++) {
-      Theorem *t = theorems_3x3[i];
-      if (t->applies(game->get_board(), Go::opponent(c))) {
-        theorem_hits[i] += 1;
-        best.value = -1 * t->get_value();
-        best.terminal = true;
-        best.benson = true;
-        return best;
-      }
+  // like the cutoffs below, verdicts don't come with a move for the root
+  if (game->size() == 3 && d > 0) {
+    int t = theorems_3x3.lookup(game->get_board(), Go::opponent(c));
+    if (t >= 0) {
+      theorem_hits[t] += 1;
+      STATS(stats.theorem_hits_by_depth[SearchStats::depth_index(d)]++);
+      best.value = -1 * theorems_3x3.value(t);
+      best.terminal = true;
+      best.benson = true;
+      return best;
+    }
+  }
+
+  long key = TranspositionTable::key(game->get_board(), c,
+      game->last_move_was_pass());
+  if (d == 0) key ^= root_history;
+  STATS(stats.tt_probes++);
+  const TT_entry *e = TT.probe(key);
+  int hint = e != nullptr ? e->best_move : UNDEFINED;
+  if (hint == UNDEFINED && d == pv_depth &&
+      d < static_cast<int>(expected_pv.size())) {
+    hint = expected_pv[d];
+  }
+  // the root has to return a move, which only exact entries are sure to hold
+  if (e != nullptr && d == 0 &&
+      (e->bound != EXACT_BOUND || e->best_move == UNDEFINED)) {
+    e = nullptr;
+  }
+  // and one superko allows
+  if (e != nullptr && d == 0) {
+    if (game->make_move(e->best_move, c)) {
+      game->undo_move();
+    } else {
+      e = nullptr;
+    }
+  }
+  if (e != nullptr && (e->bound == EXACT_BOUND ||
+        (e->bound == LOWER_BOUND && e->value >= beta) ||
+        (e->bound == UPPER_BOUND && e->value <= alpha))) {
+    STATS(stats.tt_hits++);
+    best.value = e->value;
+    best.best_move = e->best_move;
+    best.terminal = true;
+    return best;
+  }
+
+  // stones that can't be captured and their eyes belong to their owner
+  // for the rest of the game, which bounds the final score both ways. The
+  // root still has to search for a move.
+  if (safety_pruning && d > 0) {
+    const Board& b = game->get_board();
+    int points = b.n * b.n;
+    Color opp = Go::opponent(c);
+    int empty = bit_count(b.empty_points());
+    // only look for settled points if there could be enough of them
+    float lower = -points, upper = points;
+    if (2 * (bit_count(b.stones[c]) + empty) - points >= beta) {
+      lower = 2 * b.settled_points(c) - points;
+    }
+    if (points - 2 * (bit_count(b.stones[opp]) + empty) <= alpha) {
+      upper = points - 2 * b.settled_points(opp);
+    }
+    if (lower >= beta || upper <= alpha) {
+      STATS(stats.safety_cutoffs++);
+      best.value = lower >= beta ? lower : upper;
+      best.terminal = true;
+      return best;
     }
   }
 
+  // a pass here could end the game, which no region's own search knows,
+  // and the root has to return a move
+  if (safety_pruning && decomposition && d > 0 && !game->last_move_was_pass() &&
+      decompose(game->get_board(), c, &best.value)) {
+    STATS(stats.region_cutoffs++);
+    best.terminal = true;
+    return best;
+  }
+
+  // the root has to search its moves to report their values
+  if (etc && d > 0 && transposition_cutoff(game, c, beta, &best)) {
+    STATS(stats.etc_cutoffs++);
+    return best;
+  }
+
   nodes += 1;
+  STATS(stats.nodes_by_depth[SearchStats::depth_index(d)]++);
+  if (info != nullptr && (nodes & 4095) == 0) {
+    print_info(best, max_depth, game->size(), true);
+  }
+  float alpha_orig = alpha;
+  long rejects_before = superko_rejects;
 
   // generate and sort moves
-  std::vector<int> moves;
+  std::vector<int>& moves = move_lists[d];
   game->get_moves(&moves);
 
   if (game->size() == 3) {
     std::sort(moves.begin(), moves.end(),
-      move_ordering_3x3(game->get_board(), c, d));
+      move_ordering_3x3(game->get_board(), c, killer_table[d]));
   } else if (game->size() == 2) {
     std::sort(moves.begin(), moves.end(), move_ordering_2x2());
+  } else if (ordering != nullptr) {
+    order_moves(game->get_board(), c, killer_table[d], &moves);
+  }
+  // the stored or expected best move goes first
+  if (hint != UNDEFINED) {
+    auto it = std::find(moves.begin(), moves.end(), hint);
+    if (it != moves.end()) std::rotate(moves.begin(), it, it + 1);
   }
 
   bool undefined = false;
+  bool first = true;
+  STATS(int searched = 0);
   for (auto move : moves) {
     if (game->fills_eye(move, c)) {
+      STATS(stats.eye_fill_skips++);
       continue;
     }
     bool legal = game->make_move(move, c);
-    if (!legal) continue;
-    Result r = alpha_beta(game, Go::opponent(c), -1 * beta, -1 * alpha, d + 1,
-        max_depth);
+    if (!legal) {
+      if (game->rejected_by_superko()) {
+        superko_rejects++;
+        STATS(stats.superko_rejections++);
+      }
+      continue;
+    }
+    STATS(searched++);
+    bool follows_pv = d == pv_depth &&
+      d < static_cast<int>(expected_pv.size()) && move == expected_pv[d];
+    if (follows_pv) pv_depth++;
+    Result r;
+    if (pvs && !first && beta - alpha > PVS_WINDOW) {
+      // only check that the move is no better than alpha, and search it
+      // again with the full window if it is
+      r = alpha_beta(game, Go::opponent(c), -1 * alpha - PVS_WINDOW,
+          -1 * alpha, d + 1, max_depth);
+      if (!r.is_undefined() && -1 * r.value > alpha &&
+          -1 * r.value < beta) {
+        STATS(stats.pvs_researches++);
+        r = alpha_beta(game, Go::opponent(c), -1 * beta, -1 * alpha, d + 1,
+            max_depth);
+      }
+    } else {
+      r = alpha_beta(game, Go::opponent(c), -1 * beta, -1 * alpha, d + 1,
+          max_depth);
+    }
+    first = false;
+    if (follows_pv) pv_depth--;
 
     r.pv.push_front(r.best_move);
     r.best_move = move;
@@ -84,8 +365,14 @@ Result Solver::alpha_beta(Go *game, Color c, float alpha, float beta, int d,
     game->undo_move();
 
     if (d == 0 && verbose) {
-      std::cout << Board::get_point_coord(move, game->size()) << " ";
-      std::cout << r.value << std::endl;
+      std::clog << Board::get_point_coord(move, game->size()) << " ";
+      std::clog << r.value << "\n";
+    }
+    if (d == 0 && !r.is_undefined() &&
+        (provisional.is_undefined() || r.value > provisional.value)) {
+      provisional = r;
+    } else if (d == 0 && provisional.best_move == UNDEFINED) {
+      provisional.best_move = move;
     }
 
     if (r.is_undefined()) {
@@ -100,56 +387,82 @@ Result Solver::alpha_beta(Go *game, Color c, float alpha, float beta, int d,
     }
     // pruning
     if (alpha >= beta) {
+      STATS(stats.cutoffs++);
+      STATS(if (searched == 1) stats.first_move_cutoffs++);
       killer_table[d] = r.best_move;
       break;
     }
   }
 
-  if (undefined) best.reset();
+  if (undefined) {
+    best.reset();
+  } else if (superko_rejects == rejects_before) {
+    Bound bound = EXACT_BOUND;
+    if (best.value <= alpha_orig) bound = UPPER_BOUND;
+    else if (best.value >= beta) bound = LOWER_BOUND;
+    TT.store(key, best.value, best.best_move, bound);
+  }
+  if (samples != nullptr && !undefined && best.value > alpha_orig) {
+    record_sample(game->get_board(), c, moves, best.best_move);
+  }
   best.benson = false;
 
   return best;
 }
 
+void Solver::print_info(const Result& r, int max_depth, int board_size,
+    bool progress) {
+  float seconds = std::chrono::duration_cast<float_seconds>(
+      Clock::now() - start).count();
+  // progress reports from inside an iteration are rate limited
+  if (progress) {
+    if (seconds < next_info) return;
+    next_info = seconds + INFO_SECONDS;
+  }
+  std::ostream& os = *info;
+  os << "info depth " << max_depth << " nodes " << nodes;
+  os << " nps " << (seconds > 0 ? nodes / seconds : 0);
+  os << " time " << seconds;
+  if (!progress && !r.is_undefined()) {
+    os << " score " << r.value << " pv";
+    int shown = 0;
+    for (int m : r.pv) {
+      if (m == UNDEFINED || shown++ == INFO_PV_LENGTH) break;
+      os << " " << Board::get_point_coord(m, board_size);
+    }
+  } else if (provisional.best_move != UNDEFINED &&
+      !provisional.is_undefined()) {
+    os << " best " << Board::get_point_coord(provisional.best_move,
+        board_size);
+    os << " lowerbound " << provisional.value;
+  }
+  os << std::endl;
+}
+
 void Solver::display_results(Result r, int max_depth, int board_size) {
-  std::cout << "theorem hits: [";
+  std::clog << "theorem hits: [";
   for (int hn : theorem_hits) {
-    std::cout << " " << hn;
+    std::clog << " " << hn;
   }
-  std::cout << " ]" << std::endl;
+  std::clog << " ]\n";
   auto dur = std::chrono::duration_cast<float_seconds>(Clock::now() - start);
-  std::cout << "d: " << max_depth;
+  std::clog << "d: " << max_depth;
   if (!r.is_undefined()) {
-    std::cout << " value: " << r.value << " move: ";
-    std::cout << Board::get_point_coord(r.best_move, board_size);
+    std::clog << " value: " << r.value << " move: ";
+    std::clog << Board::get_point_coord(r.best_move, board_size);
   } else {
-    std::cout << " undefined";
+    std::clog << " undefined";
   }
-  std::cout << " nodes: " << nodes;
-  std::cout << " nodes/sec: " << nodes / dur.count() << std::endl;
+  std::clog << " nodes: " << nodes;
+  std::clog << " nodes/sec: " << nodes / dur.count() << "\n";
 
   if (!r.is_undefined()) {
-    std::cout << "pv:";
+    std::clog << "pv:";
     for (int m : r.pv) {
-      std::cout << " " << Board::get_point_coord(m, board_size) << " ";
+      std::clog << " " << Board::get_point_coord(m, board_size) << " ";
     }
-    std::cout << std::endl;
+    std::clog << "\n";
   }
+  std::clog << std::flush;
 }
 
-void Solver::init_theorems_3x3() {
-  theorems_3x3.push_back(new Middle3x3());
-  theorems_3x3.push_back(new Corner3x3());
-  theorems_3x3.push_back(new SideOnly3x3());
-  theorems_3x3.push_back(new SideSingle3x3());
-  theorems_3x3.push_back(new SideDouble3x3());
-  theorems_3x3.push_back(new CornerSingle3x3());
-  theorem_hits.resize(theorems_3x3.size());
-  std::fill(theorem_hits.begin(), theorem_hits.end(), 0);
-}
-
-void Solver::clean_theorems_3x3() {
-  for (auto t : theorems_3x3) {
-    delete t;
-  }
-}
@@ -2,17 +2,61 @@
 #pragma once
 
 #include<chrono>
-#include <list>
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <ostream>
+#include <vector>
 #include "Go.h"
+#include "ordering.h"
+#include "regions.h"
 #include "theorems.h"
+#include "search_stats.h"
+#include "transposition_table.h"
 
 typedef std::chrono::system_clock Clock;
 typedef std::chrono::duration<float> float_seconds;
 
+// how often searches report progress, and how much of the pv they show
+constexpr float INFO_SECONDS = 1;
+constexpr int INFO_PV_LENGTH = 8;
+
 constexpr long MAX_NODES = 0;
+// scores are whole points, so a window this wide holds no value
+constexpr float PVS_WINDOW = 1;
 constexpr int UNDEFINED = -2;
 
+// a sequence of moves held in place, so results can pass one up the search
+// without allocating. Moves are added at the front as each node returns.
+class Line {
+  int moves[MAX_DEPTH + 1];  // last move first
+  int length;
+
+ public:
+  typedef std::reverse_iterator<const int*> const_iterator;
+
+  Line() : length(0) {}
+  // only the moves in use are copied
+  Line(const Line& l) : length(l.length) {
+    std::copy(l.moves, l.moves + length, moves);
+  }
+  Line& operator=(const Line& l) {
+    length = l.length;
+    std::copy(l.moves, l.moves + length, moves);
+    return *this;
+  }
+
+  void push_front(int move) {
+    if (length <= MAX_DEPTH) moves[length++] = move;
+  }
+  void pop_front() { length--; }
+  int front() const { return moves[length - 1]; }
+  int size() const { return length; }
+  bool empty() const { return length == 0; }
+  const_iterator begin() const { return const_iterator(moves + length); }
+  const_iterator end() const { return const_iterator(moves); }
+};
+
 struct Result {
   Result() : value(-1*MAX_VAL), best_move(UNDEFINED), terminal(false),
     benson(false) {}
@@ -20,9 +64,9 @@ struct Result {
   int best_move;
   bool terminal;
   bool benson;
-  std::list<int> pv;
+  Line pv;
 
-  bool is_undefined() { return !terminal; }
+  bool is_undefined() const { return !terminal; }
 
   void reset() {
     value = -1 * MAX_VAL;
@@ -46,48 +90,37 @@ struct Result {
   }
 };
 
-struct TT_entry {
-  TT_entry() {}
-  TT_entry(Result r, Color c, int d) : res(r), to_move(c), max_depth(d) {}
-  Result res;
-  Color to_move;
-  int max_depth;
-};
-
 static constexpr int side_rank[9] = {0, 1, 0, 1, 2, 1, 0, 1, 0};
 
-static int killer_table[MAX_DEPTH] = {-2};
-
 struct move_ordering_3x3 {
  private:
-  Board& b;
+  const Board& b;
   Color c;
-  int depth;
+  int killer;
 
  public:
-  move_ordering_3x3(Board& _b, Color _c, int d) : b(_b), c(_c), depth(d) {}
+  move_ordering_3x3(const Board& _b, Color _c, int _killer) : b(_b), c(_c),
+    killer(_killer) {}
 
-  // i > j functor for move ordering
+  // i > j functor for move ordering, it looks at the moves without
+  // playing them. Passes rank with illegal moves.
   bool operator()(int i, int j) const {
-    Board b_i(b), b_j(b);
-    bool res_i, res_j;
-    res_i = b_i.move(i, c);
-    res_j = b_j.move(j, c);
+    int libs_i = i < 0 ? 0 : b.liberties_after(i, c);
+    int libs_j = j < 0 ? 0 : b.liberties_after(j, c);
 
     // if one of them is the killer and legal, it has highest priority
-    if (res_i && killer_table[depth] == i && !b_i.atari(i)) return true;
-    if (res_j && killer_table[depth] == j && !b_j.atari(j)) return false;
-
+    if (killer == i && libs_i > 1) return true;
+    if (killer == j && libs_j > 1) return false;
 
     // make sure the moves are legal and they don't put c into atari
-    if (!res_i || b_i.atari(i)) return false;
-    if (!res_j || b_j.atari(j)) return true;
+    if (libs_i <= 1) return false;
+    if (libs_j <= 1) return true;
 
     // compare scores for area gained heuristic
-    float score_i = b_i.score(c);
-    float score_j = b_j.score(c);
-    if (score_i > score_j) return true;
-    if (score_i < score_j) return false;
+    int gain_i = b.score_delta(i, c);
+    int gain_j = b.score_delta(j, c);
+    if (gain_i > gain_j) return true;
+    if (gain_i < gain_j) return false;
 
     if (i < 0) return true;
     if (j < 0) return false;
@@ -107,18 +140,105 @@ class Solver {
  private:
   long nodes;
   bool verbose;
+  bool safety_pruning;
+  bool pvs;
+  bool decomposition;
+  bool etc;
+  const OrderingWeights *ordering;
+  std::vector<OrderingSample> *samples;
   Clock::time_point start;
-  std::vector<Theorem*> theorems_3x3;
+  const TheoremTable3x3& theorems_3x3;
   std::vector<int> theorem_hits;
-  std::map<long, TT_entry> TT;
+  TranspositionTable TT;
+  LocalSolver regions;
+  // superko rejections seen so far, results that depend on one are not
+  // stored since another history could change them
+  long superko_rejects;
+  // digest of the superko history at the root, which only its own table
+  // entry includes since it has to hold a move that is legal now
+  long root_history;
+  std::atomic<bool> stopping;
+  SearchStats stats;
+  int killer_table[MAX_DEPTH];
+  Result last;
+  // best root move of the current solve whose value is proven, or just the
+  // first legal one, played if the solve is stopped
+  Result provisional;
+  std::ostream *info;
+  float next_info;
+  // what the last solve proved, reused when a later root lies on its pv
+  std::vector<int> last_pv;
+  std::vector<long> pv_keys;  // table key after each move of last_pv
+  int proven_depth;
+  // pv still expected from the current root, and how many plies of it the
+  // position being searched follows
+  std::vector<int> expected_pv;
+  int pv_depth;
+  std::vector<std::vector<int>> move_lists;  // legal moves at each ply
+  // continue from the last solve if the root is on its pv, returns the plies
+  // played since then or -1
+  int resume(Go *game, Color c);
+  void remember_pv(Go *game, Color c, const Result& r, int max_depth);
   Result alpha_beta(Go *game, Color c, float alpha, float beta, int depth,
       int max_depth);
+  // the value for c of a board whose regions are all cold, false if it
+  // isn't one
+  bool decompose(const Board& b, Color c, float *value);
+  // a move whose stored result already refutes the node, without making
+  // any, false if there is none
+  bool transposition_cutoff(Go *game, Color c, float beta, Result *r);
+  // sort moves by their ordering weights, the killer move first
+  void order_moves(const Board& b, Color c, int killer,
+      std::vector<int> *moves);
+  void record_sample(const Board& b, Color c, const std::vector<int>& moves,
+      int best_move);
   void display_results(Result r, int max_depth, int board_size);
-  void init_theorems_3x3();
-  void clean_theorems_3x3();
+  // progress lines come from inside an iteration and don't have a result
+  void print_info(const Result& r, int max_depth, int board_size,
+      bool progress);
 
  public:
   Solver();
+  // a table of 2^table_bits entries, smaller ones suit many solvers at once.
+  // The region cache is scaled along with it.
+  explicit Solver(bool _verbose, int table_bits = TT_BITS);
+  ~Solver();
   int solve(Go *game, Color c);
   int solve(Go *game, Color c, int max_depth);
+  // counters from the most recent call to solve
+  const SearchStats& get_stats() const { return stats; }
+  // root result of the most recent call to solve
+  const Result& get_result() const { return last; }
+  long get_nodes() const { return nodes; }
+  void set_verbose(bool _verbose) { verbose = _verbose; }
+  // cut off nodes whose score is decided by stones that can't be captured,
+  // on by default
+  void set_safety_pruning(bool on) { safety_pruning = on; }
+  // principal variation search: every move after the first is searched
+  // with a null window and only searched again if it beats alpha
+  void set_pvs(bool on) { pvs = on; }
+  // score boards that settled points split into cold regions (see
+  // regions.h) without searching them, on by default. Like the bounds it
+  // builds on, it only applies while safety pruning is on.
+  void set_decomposition(bool on) { decomposition = on; }
+  // enhanced transposition cutoffs: before searching a node, look up the
+  // positions its moves lead to and stop if one is stored as a refutation,
+  // on by default
+  void set_etc(bool on) { etc = on; }
+  // weights that order moves on boards larger than 3x3 (see ordering.h),
+  // tuned_ordering() by default, nullptr to leave them in board order
+  void set_ordering(const OrderingWeights *w) { ordering = w; }
+  // append every node's legal moves and the best of them to *s, for fitting
+  // ordering weights, nullptr to stop
+  void set_samples(std::vector<OrderingSample> *s) { samples = s; }
+  // write a progress line to os after every iteration and every
+  // INFO_SECONDS in between, nullptr for none
+  void set_info(std::ostream *os) { info = os; }
+  // make a running solve return as soon as possible. Its result is then
+  // undefined and it returns the best move proven so far, or the first legal
+  // one if nothing was. Stays in effect until clear_stop is called.
+  void stop() { stopping = true; }
+  void clear_stop() { stopping = false; }
+  // forget every stored result, e.g. when a new game starts
+  void clear();
 };
@@ -0,0 +1,56 @@
+// Copyright 2019 Chris Solinas
+#include "theorems.h"
+
+// the base 3 value of each set of points, with a digit of 1 per point
+struct Ternary {
+  int digits[512] = {0};
+  constexpr Ternary() {
+    for (int mask = 0; mask < 512; mask++) {
+      int power = 1;
+      for (int i = 0; i < 9; i++, power *= 3) {
+        if (mask & (1 << i)) digits[mask] += power;
+      }
+    }
+  }
+};
+static constexpr Ternary ternary;
+
+TheoremTable3x3::TheoremTable3x3() {
+  // checked in this order, the first that applies decides the value
+  theorems.emplace_back(new Middle3x3());
+  theorems.emplace_back(new Corner3x3());
+  theorems.emplace_back(new SideOnly3x3());
+  theorems.emplace_back(new SideSingle3x3());
+  theorems.emplace_back(new SideDouble3x3());
+  theorems.emplace_back(new CornerSingle3x3());
+
+  first[BLACK].assign(POSITIONS, -1);
+  first[WHITE].assign(POSITIONS, -1);
+  for (int key = 0; key < POSITIONS; key++) {
+    Bitboard black = 0, white = 0;
+    for (int i = 0, rest = key; i < 9; i++, rest /= 3) {
+      if (rest % 3 == 1) black |= point_bit(i);
+      if (rest % 3 == 2) white |= point_bit(i);
+    }
+    Board b(3);
+    b.set_stones(black, white);
+    for (Color c : {BLACK, WHITE}) {
+      for (size_t t = 0; t < theorems.size(); t++) {
+        if (theorems[t]->applies(b, c)) {
+          first[c][key] = t;
+          break;
+        }
+      }
+    }
+  }
+}
+
+const TheoremTable3x3& TheoremTable3x3::get() {
+  static const TheoremTable3x3 table;
+  return table;
+}
+
+int TheoremTable3x3::key(const Board& b) {
+  return ternary.digits[static_cast<int>(b.stones[BLACK])] +
+    2 * ternary.digits[static_cast<int>(b.stones[WHITE])];
+}
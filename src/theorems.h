@@ -1,8 +1,10 @@
 // Copyright 2019 Chris Solinas
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
-#include "board.h"
+#include "Go.h"
 #include <iostream>
 
 class Theorem {
@@ -25,20 +27,20 @@ class Corner3x3 : public Theorem {
   Corner3x3() { value = 9; }
 
   bool applies(const Board& b, Color c) {
-    long positions[] = {26, 50, 152, 176};
-    long liberties[] = {1, 4, 64, 256};
+    Bitboard positions[] = {26, 50, 152, 176};
+    Bitboard liberties[] = {1, 4, 64, 256};
 
-    long empty = b.empty_points();
+    Bitboard empty = b.empty_points();
     for (int i = 0; i < 4; i++) {
-      long position = positions[i];
+      Bitboard position = positions[i];
       // check that if matches the shape and has the corresponding corner
       // liberty first
       if ((position & b.stones[c]) == position) {
-        long liberty = liberties[i];
+        Bitboard liberty = liberties[i];
         if ((liberty & empty) == liberty) {
           // matches required shape for corner theorem, just need
           // an additional liberty to make it safe
-          long other = ~(liberty | position);
+          Bitboard other = ~(liberty | position);
           if ((other & empty) != 0) {
             return true;
           }
@@ -55,7 +57,7 @@ class Middle3x3 : public Theorem {
   Middle3x3() { value = 9; }
 
   bool applies(const Board& b, Color c) {
-    long empty = b.empty_points();
+    Bitboard empty = b.empty_points();
     // .x.
     // .x.
     // .x.
@@ -88,7 +90,7 @@ class SideSingle3x3 : public Theorem {
   SideSingle3x3() { value = 3; }
 
   bool applies(const Board &b, Color c) {
-    long sides[] = { 2, 8, 32, 128 };
+    Bitboard sides[] = { 2, 8, 32, 128 };
     Color opp = Go::opponent(c);
     if (b.stones[opp] != 0) return false;
     for (auto side : sides) {
@@ -103,7 +105,7 @@ class SideDouble3x3 : public Theorem {
   SideDouble3x3() { value = 3; }
 
   bool applies(const Board &b, Color c) {
-    long sides[] = { 3, 6, 9, 36, 72, 192, 288, 384};
+    Bitboard sides[] = { 3, 6, 9, 36, 72, 192, 288, 384};
     Color opp = Go::opponent(c);
     if (b.stones[opp] != 0) return false;
     for (auto side : sides) {
@@ -118,7 +120,7 @@ class CornerSingle3x3 : public Theorem {
   CornerSingle3x3() { value = -9; }
 
   bool applies(const Board &b, Color c) {
-    long sides[] = { 1, 4, 64, 256 };
+    Bitboard sides[] = { 1, 4, 64, 256 };
     Color opp = Go::opponent(c);
     if (b.stones[opp] != 0) return false;
     for (auto side : sides) {
@@ -133,8 +135,8 @@ class SideOnly3x3 : public Theorem {
   SideOnly3x3() { value = -9; }
 
   bool applies(const Board& b, Color c) {
-    long sides[] = { 5, 73, 292, 448 };
-    long empty = b.empty_points();
+    Bitboard sides[] = { 5, 73, 292, 448 };
+    Bitboard empty = b.empty_points();
     for (auto side : sides) {
       // 2^9 -1 = 511 (full board)
       if (b.stones[c] == side && (side | empty) == 511) {
@@ -144,3 +146,30 @@ class SideOnly3x3 : public Theorem {
     return false;
   }
 };
+
+/*
+ * The verdict of every 3x3 theorem for every 3x3 position
+ *
+ * A 3x3 board has only 3^9 stone configurations, so the first theorem that
+ * applies is worked out for each of them and each color once, and a search
+ * node looks it up instead of asking every theorem in turn. Positions are
+ * keyed in base 3 with one digit per point: 0 empty, 1 black, 2 white.
+ *
+ * The table is built on first use and shared by every solver.
+ * */
+class TheoremTable3x3 {
+  static constexpr int POSITIONS = 19683;
+  std::vector<std::unique_ptr<Theorem>> theorems;
+  // index of the first theorem that applies to each color, -1 for none
+  std::vector<int8_t> first[2];
+
+  TheoremTable3x3();
+
+ public:
+  static const TheoremTable3x3& get();
+  static int key(const Board& b);
+  // the first theorem that applies to c's stones, -1 if none does
+  int lookup(const Board& b, Color c) const { return first[c][key(b)]; }
+  float value(int theorem) const { return theorems[theorem]->get_value(); }
+  int size() const { return theorems.size(); }
+};
@@ -0,0 +1,69 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <vector>
+#include "board.h"
+
+/*
+ * Fixed size table of proven search results
+ *
+ * Only proven values are stored, together with whether they are exact or
+ * only a bound from a cutoff, so entries stay valid from one iteration and
+ * one search to the next. Keys combine the board hash with the side to move,
+ * whether the last move was a pass and the board size. Each key maps to a
+ * single slot and newer results always replace older ones.
+ * */
+
+enum Bound : char { NO_BOUND = 0, EXACT_BOUND, LOWER_BOUND, UPPER_BOUND };
+
+constexpr int TT_BITS = 20;
+
+struct TT_entry {
+  long key;
+  float value;
+  int best_move;
+  Bound bound;
+};
+
+class TranspositionTable {
+  std::vector<TT_entry> entries;
+  long mask;
+
+ public:
+  explicit TranspositionTable(int bits = TT_BITS) :
+    entries(1L << bits), mask((1L << bits) - 1) {
+    clear();
+  }
+
+  static long key(const Board& b, Color to_move, bool after_pass) {
+    return key(b.h, b.n, to_move, after_pass);
+  }
+  // the same from the board's hash, e.g. one from Board::hash_after
+  static long key(long hash, int n, Color to_move, bool after_pass) {
+    long k = hash ^ (0x9E3779B97F4A7C15L * n);
+    if (to_move == WHITE) k ^= 0x5851F42D4C957F2DL;
+    if (after_pass) k ^= 0x14057B7EF767814FL;
+    return k;
+  }
+
+  // the entry stored for key, nullptr if there is none
+  const TT_entry* probe(long key) const {
+    const TT_entry& e = entries[key & mask];
+    return e.bound != NO_BOUND && e.key == key ? &e : nullptr;
+  }
+
+  // start loading the slot for key so a later probe doesn't wait on memory
+  void prefetch(long key) const { __builtin_prefetch(&entries[key & mask]); }
+
+  void store(long key, float value, int best_move, Bound bound) {
+    TT_entry& e = entries[key & mask];
+    e.key = key;
+    e.value = value;
+    e.best_move = best_move;
+    e.bound = bound;
+  }
+
+  void clear() {
+    for (auto& e : entries) e.bound = NO_BOUND;
+  }
+};
@@ -0,0 +1,65 @@
+// Copyright 2019 Chris Solinas
+#include "tuner.h"
+
+#include "solver.h"
+
+static bool held_out(size_t i, int holdout) {
+  return holdout > 0 && static_cast<int>(i % holdout) == holdout - 1;
+}
+
+// solve p with the given weights, adding the solver's samples to *samples
+static void solve_with(const BatchPosition& p, const OrderingWeights& w,
+    Solver *solver, std::vector<OrderingSample> *samples, float *value,
+    long *nodes) {
+  Go game(p.n);
+  p.setup(&game);
+  solver->clear();
+  solver->set_ordering(&w);
+  solver->set_samples(samples);
+  solver->solve(&game, p.to_move);
+  solver->set_samples(nullptr);
+  *value = solver->get_result().value;
+  *nodes = solver->get_nodes();
+}
+
+TuneResult tune_ordering(const std::vector<BatchPosition>& positions,
+    int holdout, int epochs, OrderingWeights *w) {
+  TuneResult result;
+  Solver solver(false);
+  std::vector<OrderingSample> train, test;
+  std::vector<float> values;
+  OrderingWeights before = *w;
+  float value;
+  long nodes;
+  for (size_t i = 0; i < positions.size(); i++) {
+    const BatchPosition& p = positions[i];
+    Go game(p.n);
+    if (!p.error.empty() || !p.setup(&game)) continue;
+    bool test_position = held_out(i, holdout);
+    solve_with(p, before, &solver, test_position ? &test : &train, &value,
+        &nodes);
+    if (test_position) {
+      result.test++;
+      result.nodes_before += nodes;
+      values.push_back(value);
+    } else {
+      result.train++;
+    }
+  }
+  result.samples = train.size();
+  fit_ordering(train, epochs, w);
+
+  result.likelihood_before = ordering_likelihood(test, before);
+  result.likelihood_after = ordering_likelihood(test, *w);
+  size_t k = 0;
+  for (size_t i = 0; i < positions.size(); i++) {
+    const BatchPosition& p = positions[i];
+    Go game(p.n);
+    if (!p.error.empty() || !p.setup(&game)) continue;
+    if (!held_out(i, holdout)) continue;
+    solve_with(p, *w, &solver, nullptr, &value, &nodes);
+    result.nodes_after += nodes;
+    if (value != values[k++]) result.values_match = false;
+  }
+  return result;
+}
@@ -0,0 +1,36 @@
+// Copyright 2019 Chris Solinas
+#pragma once
+
+#include <vector>
+#include "batch.h"
+#include "ordering.h"
+
+/*
+ * Fit move ordering weights to a corpus of positions
+ *
+ * Every holdout'th position is held out, the rest are solved with the
+ * current weights while the solver records the best move of every node.
+ * New weights are fit to those samples, and the held out positions are
+ * solved with both the current and the new weights, which must prove the
+ * same values, to see whether the new ones save nodes.
+ * */
+
+struct TuneResult {
+  TuneResult() : train(0), test(0), samples(0), likelihood_before(0),
+    likelihood_after(0), nodes_before(0), nodes_after(0),
+    values_match(true) {}
+  long train;  // positions fit to
+  long test;   // positions held out
+  long samples;
+  // mean log likelihood of the held out positions' best moves
+  double likelihood_before;
+  double likelihood_after;
+  // nodes to solve the held out positions
+  long nodes_before;
+  long nodes_after;
+  bool values_match;
+};
+
+// fit new weights to positions, starting from *w, and write them to *w
+TuneResult tune_ordering(const std::vector<BatchPosition>& positions,
+    int holdout, int epochs, OrderingWeights *w);
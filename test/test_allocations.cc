@@ -0,0 +1,63 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <sstream>
+#include <string>
+#include "allocations.h"
+#include "batch.h"
+#include "solver.h"
+
+void test_counting() {
+  // called directly, which the compiler can't leave out the way it can a
+  // new expression whose memory is never used
+  long before = thread_allocations();
+  void *p = ::operator new(16);
+  assert(thread_allocations() - before == 1);
+  ::operator delete(p);
+}
+
+// allocations made solving position on a solver that has already solved it
+long solve_again(const char *position, int n, Color c) {
+  Board b(n);
+  assert(Board::from_string(position, n, &b));
+  Go g(b);
+  Solver s(false, 16);
+  s.solve(&g, c);
+  float value = s.get_result().value;
+  s.clear();
+  long before = thread_allocations();
+  s.solve(&g, c);
+  long allocations = thread_allocations() - before;
+  assert(s.get_result().value == value);
+  return allocations;
+}
+
+void test_solve() {
+  // positions that use the theorems, ordering weights, safety pruning,
+  // regions, enhanced transposition cutoffs and superko
+  assert(solve_again(".b./.wb/w..", 3, BLACK) == 0);
+  assert(solve_again(".../.../...", 3, WHITE) == 0);
+  assert(solve_again("wwb./bwww/..w./ww.w", 4, BLACK) == 0);
+  assert(solve_again(".bb./b.bb/wwww/..w.", 4, WHITE) == 0);
+  assert(solve_again(".wb./wwbb/b.bw/wwb.", 4, BLACK) == 0);
+}
+
+void test_batch() {
+  // every line ends with the allocations its solve made
+  std::stringstream in, out;
+  in << "3 .b./.wb/w.. b\n";
+  in << "3 .../.b./... w b:b2\n";
+  // long local games in its regions
+  in << "5 .bbw./bbw.w/.bwwb/bbwb./www.b b\n";
+  assert(run_batch(in, out, 1) == 0);
+  std::string line;
+  while (std::getline(out, line)) {
+    assert(line.substr(line.rfind(' ')) == " 0");
+  }
+}
+
+int main() {
+  test_counting();
+  test_solve();
+  test_batch();
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include "batch.h"
+
+void test_parse() {
+  BatchPosition p;
+  assert(parse_batch_position("3 .../.b./... w", &p));
+  assert(p.n == 3 && p.to_move == WHITE);
+  assert(p.board.stones[BLACK] == 16 && p.board.stones[WHITE] == 0);
+  assert(p.history.empty());
+
+  BatchPosition q;
+  assert(parse_batch_position("3 b../.w./... b b:a1 w:pass w:b2", &q));
+  assert(q.history.size() == 3);
+  assert(q.history[1].first == WHITE && q.history[1].second == PASS_IND);
+  Go g(3);
+  assert(q.setup(&g));
+  // the history doesn't reach this board
+  assert(parse_batch_position("3 .../.w./..b b b:a1 w:b2", &q));
+  assert(!q.setup(&g));
+
+  BatchPosition bad;
+  assert(!parse_batch_position("3 ../.b./... w", &bad));
+  assert(!parse_batch_position("3 .../.b./... x", &bad));
+  assert(!parse_batch_position("3 .../.b./... w b:z9", &bad));
+  // a stone without liberties
+  assert(!parse_batch_position("2 bw/w. b", &bad));
+}
+
+void test_superko_from_board() {
+  // the starting position counts as played, so it can't be repeated
+  Board b(2);
+  assert(Board::from_string("b./..", 2, &b));
+  Go g(b);
+  assert(g.make_move(3, WHITE));
+  assert(g.make_move(1, BLACK));
+  assert(g.make_move(2, WHITE));
+  assert(g.make_move(0, BLACK));
+  assert(g.make_move(1, WHITE));
+  assert(!g.make_move(0, BLACK));
+  assert(g.rejected_by_superko());
+}
+
+void test_run_batch() {
+  std::stringstream in;
+  in << "# comment\n";
+  in << "2 ../.. b\n";
+  in << "\n";
+  in << "3 .../.b./... w b:b2\n";
+  in << "3 .../.b./... q\n";
+  in << "2 ../.. w\n";
+  std::stringstream out;
+  assert(run_batch(in, out, 3) == 1);
+
+  std::string line;
+  std::getline(out, line);
+  assert(line.find("2 ") == 0);
+  std::getline(out, line);
+  // white can't stop the center stone from living on 3x3
+  assert(line.find("4 ") == 0);
+  assert(line.find(" -9 ") != std::string::npos);
+  std::getline(out, line);
+  assert(line.find("5 error") == 0);
+  std::getline(out, line);
+  assert(line.find("6 ") == 0);
+  assert(!std::getline(out, line));
+
+  // every line is solved from scratch, whatever came before it
+  std::stringstream twice("3 bb./b.w/bbb b\n3 bb./b.w/bbb b\n");
+  std::stringstream answers;
+  assert(run_batch(twice, answers, 1) == 0);
+  std::string first, second;
+  std::getline(answers, first);
+  std::getline(answers, second);
+  // the same move, value and nodes after the line numbers
+  std::stringstream a(first), b(second);
+  for (int i = 0; i < 4; i++) {
+    std::string x, y;
+    a >> x;
+    b >> y;
+    assert(i == 0 || x == y);
+  }
+}
+
+void test_parse_sgf() {
+  // a ko: black takes at b3, and white may not take back at b2 at once
+  std::string game = "(;FF[4]GM[1]SZ[4]AB[ba][ab][bc]AW[ca][bb][cc][db]"
+    ";B[cb];W[dd](;B[];W[tt])(;B[aa]))";
+  BatchPosition p;
+  std::stringstream all(game);
+  assert(parse_sgf(all, 0, &p));
+  assert(p.n == 4 && p.history.empty());
+  assert(p.board.to_string() == ".bw./b.bw/.bw./...w");
+  assert(p.to_move == BLACK && p.passes == 2);
+  Go g(4);
+  assert(p.setup(&g));
+  assert(g.game_over());
+
+  // before the first move, the variation isn't part of the main line
+  BatchPosition q;
+  std::stringstream first(game);
+  assert(parse_sgf(first, 1, &q));
+  assert(q.board.to_string() == ".bw./bw.w/.bw./....");
+  assert(q.to_move == BLACK && q.passes == 0);
+
+  BatchPosition r;
+  std::stringstream second(game);
+  assert(parse_sgf(second, 2, &r));
+  assert(r.to_move == WHITE);
+  assert(r.setup(&g));
+  assert(!g.make_move(5, WHITE));
+  assert(g.rejected_by_superko());
+
+  BatchPosition setup;
+  std::stringstream empty("(;SZ[4]AB[aa:bb]PL[W])");
+  assert(parse_sgf(empty, 0, &setup));
+  assert(setup.board.stones[BLACK] == 0x33);
+  assert(setup.to_move == WHITE);
+
+  BatchPosition bad;
+  std::stringstream large("(;SZ[19];B[dd])");
+  assert(!parse_sgf(large, 0, &bad));
+  std::stringstream occupied("(;SZ[3];B[aa];W[aa])");
+  assert(!parse_sgf(occupied, 0, &bad));
+  std::stringstream off("(;SZ[3];B[dd])");
+  assert(!parse_sgf(off, 0, &bad));
+  std::stringstream text("not a game");
+  assert(!parse_sgf(text, 0, &bad));
+}
+
+int main() {
+  test_parse();
+  test_parse_sgf();
+  test_superko_from_board();
+  test_run_batch();
+  return 0;
+}
@@ -2,6 +2,7 @@
 #include <cassert>
 #include <iostream>
 #include "board.h"
+#include "random.h"
 
 void test_score() {
   Board b(2);
@@ -117,8 +118,169 @@ void test_groups() {
   assert(c.get_group(1 << 0) == 1);
 }
 
+void test_large_boards() {
+  Board b(8);
+  assert(bit_count(b.empty_points()) == 64);
+  // the most significant point must not spread through sign extension
+  assert(b.get_neighbors(point_bit(63)) == (point_bit(62) | point_bit(55)));
+  b.move(63, WHITE);
+  b.move(62, BLACK);
+  assert(b.stones[WHITE] == point_bit(63));
+  b.move(55, BLACK);
+  assert(b.stones[WHITE] == 0);
+  assert(b.score(BLACK) == 3);
+
+  Board c(6);
+  c.move(35, BLACK);
+  assert(c.get_liberties(c.get_group(point_bit(35))) ==
+      (point_bit(34) | point_bit(29)));
+
+  // the same on the widest board the build supports
+  int n = MAX_BOARD_SIZE, last = n * n - 1;
+  Board d(n);
+  assert(bit_count(d.empty_points()) == n * n);
+  assert(d.get_neighbors(point_bit(last)) ==
+      (point_bit(last - 1) | point_bit(last - n)));
+  d.move(last, WHITE);
+  d.move(last - 1, BLACK);
+  d.move(last - n, BLACK);
+  assert(d.stones[WHITE] == 0);
+  assert(d.score(BLACK) == 3);
+  assert(lowest_point(d.stones[BLACK]) == last - n);
+}
+
+void test_eyes() {
+  Board b(3);
+  b.move(1, BLACK);
+  b.move(3, BLACK);
+  assert(b.eyes(BLACK) == 1);
+  assert(b.eyes(WHITE) == 0);
+  b.move(5, WHITE);
+  b.move(7, WHITE);
+  assert(b.eyes(WHITE) == 256);
+  assert(b.fills_eye(0, BLACK) && b.fills_eye(8, WHITE));
+}
+
+void test_pass_alive() {
+  Board b(2);
+  Bitboard alive, regions;
+  // two stones that each touch both empty points can't be captured
+  assert(Board::from_string("b./.b", 2, &b));
+  b.pass_alive(BLACK, &alive, &regions);
+  assert(alive == 9 && regions == 6);
+  assert(b.settled_points(BLACK) == 4 && b.settled_points(WHITE) == 0);
+
+  // one eye isn't enough
+  Board c(3);
+  assert(Board::from_string("bbb/b.b/bbb", 3, &c));
+  c.pass_alive(BLACK, &alive, &regions);
+  assert(alive == 0 && regions == 0);
+  assert(c.settled_points(BLACK) == 0);
+
+  // an eye and a region of liberties are, but only the eye is settled
+  assert(Board::from_string("b.b/bbb/...", 3, &c));
+  c.pass_alive(BLACK, &alive, nullptr);
+  assert(alive == 61);
+  assert(c.settled_points(BLACK) == 6);
+  // a white stone in the big region doesn't change that
+  c.move(7, WHITE);
+  assert(c.settled_points(BLACK) == 6);
+  // two eyes that need a stone that can be captured
+  assert(Board::from_string("b.b/.bw/bw.", 3, &c));
+  assert(c.settled_points(BLACK) == 0);
+}
+
+void test_zobrist() {
+#ifndef WIDE_BOARD
+  // position files store hashes, so the keys must stay the same. Wide
+  // builds have keys for more points and hashes of their own.
+  Board b(4);
+  b.set_stones(0x1234, 0x8001);
+  assert(b.h == -7664627629225688621L);
+  Board c(8);
+  c.set_stones(~((1L << 40) - 1), 0xff);
+  assert(c.h == -2937075635005992213L);
+#endif
+  // the hash follows the stones, not the moves that placed them
+  Board d(4);
+  d.move(1, WHITE);
+  d.move(4, BLACK);
+  d.move(0, BLACK);
+  Board e(4);
+  e.set_stones(d.stones[BLACK], d.stones[WHITE]);
+  assert(d.h == e.h);
+}
+
+void test_incremental_counts() {
+  // random games full of captures must keep the counts
+  // the same as counting from scratch
+  Random rng(7);
+  for (int n = 2; n <= MAX_BOARD_SIZE; n++) {
+    for (int game = 0; game < 20; game++) {
+      Board b(n);
+      Color c = BLACK;
+      for (int ply = 0; ply < 3 * n * n && b.empty_points(); ply++) {
+        int point = rng.choose_bit(b.empty_points());
+        Board next(b);
+        if (!next.move(point, c)) continue;
+        assert(next.score(c) - b.score(c) == b.score_delta(point, c));
+        Board counted(next);
+        counted.count_points();
+        for (Color k : {BLACK, WHITE}) {
+          assert(next.stone_count[k] == counted.stone_count[k]);
+          assert(next.eye_count[k] == counted.eye_count[k]);
+        }
+        b = next;
+        c = Board::opponent(c);
+      }
+    }
+  }
+
+  // white's stone, the captured stone and the eye it leaves behind
+  Board b(3);
+  assert(Board::from_string("bw./.../...", 3, &b));
+  assert(b.score(WHITE) == 0);
+  assert(b.score_delta(3, WHITE) == 3);
+  assert(b.move(3, WHITE));
+  assert(b.score(WHITE) == 3);
+  assert(b.eye_count[WHITE] == 1);
+}
+
+void test_hash_after() {
+  // every empty point's hash and liberties match playing it, and suicides
+  // are refused
+  Random rng(11);
+  for (int n = 2; n <= MAX_BOARD_SIZE; n++) {
+    for (int game = 0; game < 10; game++) {
+      Board b(n);
+      Color c = BLACK;
+      for (int ply = 0; ply < 3 * n * n && b.empty_points(); ply++) {
+        for (Bitboard rest = b.empty_points(); rest; rest &= rest - 1) {
+          int point = lowest_point(rest);
+          Board next(b);
+          long h;
+          bool legal = next.move(point, c);
+          assert(b.hash_after(point, c, &h) == legal);
+          assert(!legal || h == next.h);
+          Bitboard group = next.get_group(point_bit(point));
+          int liberties = legal ? bit_count(next.get_liberties(group)) : 0;
+          assert(b.liberties_after(point, c) == liberties);
+        }
+        int point = rng.choose_bit(b.empty_points());
+        if (!b.move(point, c)) continue;
+        c = Board::opponent(c);
+      }
+    }
+  }
+}
 
 int main() {
+  test_hash_after();
+  test_incremental_counts();
+  test_zobrist();
+  test_large_boards();
+  test_eyes();
+  test_pass_alive();
   test_empty_points();
   test_groups();
   test_neighbors();
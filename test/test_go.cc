@@ -26,7 +26,59 @@ void test_pass() {
   assert(g.game_over());
 }
 
+void test_superko() {
+  Go g(2);
+  assert(g.make_move(0, BLACK));
+  assert(g.make_move(3, WHITE));
+  assert(g.make_move(1, BLACK));
+  // white captures both black stones
+  assert(g.make_move(2, WHITE));
+  assert(g.make_move(0, BLACK));
+  assert(g.make_move(1, WHITE));
+  // recapturing everything would repeat the board after the first move
+  assert(!g.make_move(0, BLACK));
+  assert(g.rejected_by_superko());
+  // occupied points are illegal without involving superko
+  assert(!g.make_move(1, BLACK));
+  assert(!g.rejected_by_superko());
+}
+
+void test_parse_point() {
+  int point;
+  assert(Go::parse_point("b2", 3, &point) && point == 4);
+  assert(Go::parse_point("pass", 3, &point) && point == PASS_IND);
+  // columns above 9 take two digits
+  assert(Go::parse_point("a10", 11, &point) && point == 9);
+  assert(Go::parse_point("k11", 11, &point) && point == 120);
+  assert(Board::get_point_coord(120, 11) == "k11");
+  assert(!Go::parse_point("a10", 9, &point));
+  assert(!Go::parse_point("a0", 9, &point));
+  assert(!Go::parse_point("a1x", 9, &point));
+  assert(!Go::parse_point("d4", 3, &point));
+}
+
+void test_parse_vertex() {
+  // GTP counts rows from the bottom and has no column i
+  int point;
+  assert(Go::parse_vertex("A1", 3, &point) && point == 6);
+  assert(Go::parse_vertex("c3", 3, &point) && point == 2);
+  assert(Go::parse_vertex("PASS", 3, &point) && point == PASS_IND);
+  assert(Go::parse_vertex("J1", 9, &point) && point == 80);
+  assert(Board::get_vertex(80, 9) == "J1");
+  assert(Go::parse_vertex("L11", 11, &point) && point == 10);
+  assert(Board::get_vertex(10, 11) == "L11");
+  assert(Board::get_vertex(4, 3) == "B2");
+  assert(!Go::parse_vertex("i1", 9, &point));
+  assert(!Go::parse_vertex("d1", 3, &point));
+  assert(!Go::parse_vertex("a4", 3, &point));
+  assert(!Go::parse_vertex("a0", 3, &point));
+  assert(!Go::parse_vertex("a1x", 9, &point));
+}
+
 int main() {
   test_pass();
+  test_superko();
+  test_parse_point();
+  test_parse_vertex();
   return 0;
 }
@@ -0,0 +1,184 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "gtp_interface.h"
+
+static std::string run(GTP_interface *gtp, std::string line) {
+  std::string out;
+  gtp->execute(&line, &out);
+  return out;
+}
+
+void test_framing() {
+  Go g(3);
+  Solver s(false);
+  MCTS m(false);
+  GTP_interface gtp(&g, &s, &m, false);
+
+  assert(run(&gtp, "protocol_version") == "= 2\n\n");
+  assert(run(&gtp, "12 name") == "=12 small_go\n\n");
+  assert(run(&gtp, "7 frobnicate") == "?7 unknown command\n\n");
+  // comments, blank lines and control characters
+  assert(run(&gtp, "   # nothing here") == "");
+  assert(run(&gtp, "") == "");
+  assert(run(&gtp, "\tknown_command\tplay\r # trailing") == "= true\n\n");
+  assert(run(&gtp, "known_command frobnicate") == "= false\n\n");
+}
+
+void test_game_commands() {
+  Go g(3);
+  Solver s(false);
+  MCTS m(false);
+  GTP_interface gtp(&g, &s, &m, false);
+
+  assert(run(&gtp, "play b b2") == "= \n\n");
+  assert(run(&gtp, "play white B2") == "? illegal move\n\n");
+  assert(run(&gtp, "play w z9") == "? syntax error\n\n");
+  assert(run(&gtp, "play w") == "? syntax error\n\n");
+  assert(run(&gtp, "3 showboard") == "=3 \n...\n.b.\n...\n\n");
+  assert(run(&gtp, "legal w").find("A3 B3 C3 A2 C2 A1 B1 C1 pass") == 2);
+  assert(run(&gtp, "undo") == "= \n\n");
+  assert(run(&gtp, "undo") == "? cannot undo\n\n");
+  // vertices count rows from the bottom
+  assert(run(&gtp, "play b c1") == "= \n\n");
+  assert(run(&gtp, "showboard") == "= \n...\n...\n..b\n\n");
+  assert(run(&gtp, "undo") == "= \n\n");
+
+  assert(run(&gtp, "boardsize " + std::to_string(MAX_BOARD_SIZE + 1)) ==
+      "? unacceptable size\n\n");
+  assert(run(&gtp, "boardsize 2") == "= \n\n");
+  assert(g.size() == 2);
+  assert(run(&gtp, "play b a1") == "= \n\n");
+  assert(run(&gtp, "clear_board") == "= \n\n");
+  assert(g.get_board().stones[BLACK] == 0);
+
+  assert(run(&gtp, "komi 0.5") == "= \n\n");
+  assert(run(&gtp, "final_score") == "= W+0.5\n\n");
+}
+
+void test_setup_commands() {
+  Go g(3);
+  Solver s(false);
+  MCTS m(false);
+  GTP_interface gtp(&g, &s, &m, false);
+
+  assert(run(&gtp, "setboard ..../.b../..w./.... w") == "= \n\n");
+  assert(g.size() == 4 && g.to_play() == WHITE);
+  assert(run(&gtp, "showboard") == "= \n....\n.b..\n..w.\n....\n\n");
+  assert(run(&gtp, "setboard ../.. x") == "? syntax error\n\n");
+  assert(run(&gtp, "setboard ../.b./.. b") == "? syntax error\n\n");
+  assert(run(&gtp, "setboard bw/w. b") == "? syntax error\n\n");
+
+  // earlier boards can't be repeated: white may not retake the ko
+  assert(run(&gtp, "setboard .bw./b.bw/.bw./.... w .bw./bw.w/.bw./....") ==
+      "= \n\n");
+  assert(run(&gtp, "play w B3") == "? illegal move\n\n");
+  assert(run(&gtp, "setboard .bw./b.bw/.bw./.... w") == "= \n\n");
+  assert(run(&gtp, "play w B3") == "= \n\n");
+
+  const char *path = "bin/test/game.sgf";
+  {
+    std::ofstream out(path);
+    out << "(;SZ[3]AB[bb];W[aa];B[ca])";
+  }
+  assert(run(&gtp, std::string("loadsgf ") + path) == "= \n\n");
+  assert(g.size() == 3 && g.to_play() == WHITE);
+  assert(g.get_board().to_string() == "w.b/.b./...");
+  assert(run(&gtp, std::string("loadsgf ") + path + " 2") == "= \n\n");
+  assert(g.get_board().to_string() == "w../.b./...");
+  assert(g.to_play() == BLACK);
+  assert(run(&gtp, "loadsgf bin/test/missing.sgf") ==
+      "? cannot load file\n\n");
+  std::remove(path);
+}
+
+void test_genmove() {
+  Go g(3);
+  Solver s(false);
+  MCTS m(false);
+  GTP_interface gtp(&g, &s, &m, false);
+  assert(run(&gtp, "genmove b") == "= B2\n\n");
+  assert(g.get_board().stones[BLACK] == 16);
+
+  // the solver's options don't change its answer
+  assert(run(&gtp, "undo") == "= \n\n");
+  assert(run(&gtp, "solver_option pvs off") == "= \n\n");
+  assert(run(&gtp, "solver_option safety off") == "= \n\n");
+  assert(run(&gtp, "solver_option regions off") == "= \n\n");
+  assert(run(&gtp, "solver_option etc off") == "= \n\n");
+  assert(run(&gtp, "genmove b") == "= B2\n\n");
+  assert(run(&gtp, "solver_option pvs maybe") == "? syntax error\n\n");
+  assert(run(&gtp, "solver_option nmp on") == "? unknown option\n\n");
+}
+
+void test_listen() {
+  Go g(2);
+  Solver s(false);
+  MCTS m(false);
+  GTP_interface gtp(&g, &s, &m, false);
+  std::stringstream in("1 play b a1\n2 quit\n3 play w a2\n");
+  std::stringstream out;
+  gtp.listen(in, out);
+  // nothing after quit is read
+  assert(out.str() == "=1 \n\n=2 \n\n");
+}
+
+void test_ponder() {
+  Go g(3);
+  Solver s(false);
+  MCTS m(false);
+  m.set_threads(1);
+  m.set_playouts(2000);
+  GTP_interface gtp(&g, &s, &m, false);
+  assert(run(&gtp, "ponder maybe") == "? syntax error\n\n");
+  std::stringstream in("1 ponder on\n2 play b b2\n3 genmove w\n"
+      "4 boardsize 4\n5 play b b2\n6 genmove w\n7 ponder off\n");
+  std::stringstream out;
+  gtp.listen(in, out);
+  // the answers are the same as without pondering
+  std::string answers = out.str();
+  assert(answers.find("=1 \n\n=2 \n\n=3 ") == 0);
+  assert(answers.find("=4 \n\n=5 \n\n=6 ") != std::string::npos);
+  assert(answers.find("=7 \n\n") != std::string::npos);
+}
+
+void test_stop() {
+  // stop reaches a genmove that would otherwise run for minutes
+  Go g(3);
+  Solver s(false);
+  MCTS m(false);
+  m.set_threads(1);
+  m.set_playouts(1L << 40);
+  m.set_time(600);
+  GTP_interface gtp(&g, &s, &m, false);
+  std::stringstream in("1 boardsize 7\n2 genmove b\n# interrupt\n3 stop\n"
+      "4 engine solver\n5 genmove w\n6 stop\n7 quit\n");
+  std::stringstream out;
+  Clock::time_point start = Clock::now();
+  gtp.listen(in, out);
+  auto dur = std::chrono::duration_cast<float_seconds>(Clock::now() - start);
+  assert(dur.count() < 5);
+  std::string answers = out.str();
+  assert(answers.find("=1 \n\n=2 ") == 0);
+  assert(answers.find("=3 \n\n=4 \n\n=5 ") != std::string::npos);
+  assert(answers.find("=6 \n\n=7 \n\n") != std::string::npos);
+  assert(bit_count(g.get_board().stones[BLACK]) == 1);
+  assert(bit_count(g.get_board().stones[WHITE]) == 1);
+  // stop on its own does nothing
+  assert(run(&gtp, "stop") == "= \n\n");
+}
+
+int main() {
+  test_framing();
+  test_game_commands();
+  test_setup_commands();
+  test_genmove();
+  test_listen();
+  test_ponder();
+  test_stop();
+  return 0;
+}
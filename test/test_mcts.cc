@@ -0,0 +1,132 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include "mcts.h"
+#include "solver.h"
+
+void test_center_3x3() {
+  // the center is the only winning first move on 3x3
+  Go g(3);
+  MCTS mcts(false);
+  mcts.set_threads(2);
+  mcts.set_playouts(20000);
+  assert(mcts.search(&g, BLACK) == 4);
+}
+
+void test_tree_reuse() {
+  Go g(5);
+  Random rng(1);
+  MCTSTree tree;
+  tree.set_root(&g, BLACK);
+  for (int i = 0; i < 2000; i++) tree.iterate(&g, &rng);
+  assert(tree.root().visits == 2000);
+
+  // find the most visited reply to the most visited move
+  int count;
+  const MCTSNode *children = tree.children(&count);
+  const MCTSNode *best = &children[0];
+  for (int i = 1; i < count; i++) {
+    if (children[i].visits > best->visits) best = &children[i];
+  }
+  int move = best->move;
+  int visits = best->visits;
+  assert(g.make_move(move, BLACK));
+  tree.set_root(&g, WHITE);
+  assert(tree.root().visits == visits);
+
+  // an unrelated position starts a new tree
+  Go other(5);
+  other.make_move(12, BLACK);
+  other.make_move(0, WHITE);
+  other.make_move(24, BLACK);
+  tree.set_root(&other, WHITE);
+  assert(tree.root().visits == 0);
+  assert(tree.size() == 1);
+
+  // so does the same board after a pass, where another pass ends the game
+  Go fresh(5);
+  tree.set_root(&fresh, BLACK);
+  for (int i = 0; i < 2000; i++) tree.iterate(&fresh, &rng);
+  Go played(fresh);
+  assert(played.make_move(12, BLACK));
+  MCTSTree reused(tree);
+  reused.set_root(&played, WHITE);
+  assert(reused.root().visits > 0);
+  Go passed(played.get_board());
+  assert(passed.make_move(PASS_IND, BLACK));
+  tree.set_root(&passed, WHITE);
+  assert(tree.root().visits == 0);
+}
+
+void test_playouts_respect_eyes() {
+  // black owns the whole board except two single point eyes, any move black
+  // makes must be a pass
+  Go g(3);
+  for (int i = 0; i < 9; i++) {
+    if (i != 0 && i != 8) g.make_move(i, BLACK);
+  }
+  MCTS mcts(false);
+  mcts.set_threads(1);
+  mcts.set_playouts(100);
+  assert(mcts.search(&g, BLACK) == PASS_IND);
+}
+
+// a stringstream that lets another thread wait for the first complete line
+class FirstLine : public std::stringbuf {
+ public:
+  // false if no line came within the timeout
+  bool wait(std::chrono::seconds timeout) {
+    std::unique_lock<std::mutex> guard(lock);
+    return written.wait_for(guard, timeout, [this]() { return lines > 0; });
+  }
+
+ protected:
+  // std::endl flushes
+  int sync() override {
+    std::lock_guard<std::mutex> guard(lock);
+    lines++;
+    written.notify_all();
+    return 0;
+  }
+
+ private:
+  std::mutex lock;
+  std::condition_variable written;
+  int lines = 0;
+};
+
+void test_stop() {
+  // a search with no useful limits ends after stop, which it takes after
+  // the first progress line. The timeouts only guard against hangs.
+  Go g(7);
+  MCTS mcts(false);
+  mcts.set_threads(2);
+  mcts.set_playouts(1L << 40);
+  mcts.set_time(600);
+  FirstLine lines;
+  std::ostream info(&lines);
+  mcts.set_info(&info);
+  std::future<int> search = std::async(std::launch::async,
+      [&]() { return mcts.search(&g, BLACK); });
+  assert(lines.wait(std::chrono::seconds(30)));
+  mcts.stop();
+  assert(search.wait_for(std::chrono::seconds(30)) ==
+      std::future_status::ready);
+  int move = search.get();
+  assert(move != UNDEFINED && g.make_move(move, BLACK));
+  assert(lines.str().find("info playouts ") == 0);
+  mcts.clear_stop();
+}
+
+int main() {
+  test_center_3x3();
+  test_tree_reuse();
+  test_playouts_respect_eyes();
+  test_stop();
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ordering.h"
+#include "solver.h"
+
+void test_features() {
+  Board b(4);
+  assert(Board::from_string("bwb./..../..../....", 4, &b));
+  MoveFeatures f;
+  // b2 captures the white stone above it, which leaves an eye
+  assert(move_features(b, 5, BLACK, &f));
+  assert(f.move == 5);
+  // up, down, left and right: opponent, then three empty points
+  assert(f.pattern == 2 * 64);
+  assert(f.diagonal == 2 * 5 + 0);
+  assert(f.captures == 1);
+  assert(f.gain == 3);
+  assert(f.liberties == 3);
+  assert(f.edge == 1);
+
+  // a4 extends the stone at a3 along the top edge
+  assert(move_features(b, 3, BLACK, &f));
+  assert(f.pattern == ((3 * 4 + 0) * 4 + 1) * 4 + 3);
+  assert(f.diagonal == 0);
+  assert(f.captures == 0);
+  assert(f.gain == 1);
+  assert(f.liberties == 1);
+  assert(f.edge == 0);
+
+  // occupied points are illegal and passes always legal
+  assert(!move_features(b, 0, WHITE, &f));
+  assert(move_features(b, PASS_IND, WHITE, &f));
+  OrderingWeights w = {};
+  w.pass = 2;
+  assert(ordering_score(w, f) == 2);
+}
+
+void test_fit() {
+  // the best move is always the one that captures
+  std::vector<OrderingSample> samples;
+  for (int i = 0; i < 50; i++) {
+    OrderingSample s;
+    for (int k = 0; k < 4; k++) {
+      MoveFeatures f = {k, static_cast<uint8_t>(i % 7), 0, 1, 0, 1,
+        static_cast<uint8_t>(k % 2)};
+      if (k == i % 4) f.captures = 1;
+      s.moves.push_back(f);
+    }
+    s.best = i % 4;
+    samples.push_back(s);
+  }
+  OrderingWeights w = {};
+  double before = ordering_likelihood(samples, w);
+  fit_ordering(samples, 10, &w);
+  assert(ordering_likelihood(samples, w) > before);
+  assert(w.captures[1] > w.captures[0]);
+
+  std::stringstream header;
+  write_ordering_header(w, header);
+  assert(header.str().find("TUNED_ORDERING_WEIGHTS") != std::string::npos);
+}
+
+void test_solver_ordering() {
+  // ordering changes how many nodes a proof takes, never its value
+  const char *positions[] = {"wwb./bwww/..w./ww.w", ".bb./b.bb/wwww/..w.",
+    ".wb./wwbb/b.bw/wwb."};
+  for (const char *position : positions) {
+    Board b(4);
+    assert(Board::from_string(position, 4, &b));
+    Go with_game(b), without_game(b);
+    Solver with(false, 16), without(false, 16);
+    without.set_ordering(nullptr);
+    std::vector<OrderingSample> samples;
+    with.set_samples(&samples);
+    with.solve(&with_game, WHITE);
+    without.solve(&without_game, WHITE);
+    assert(with.get_result().value == without.get_result().value);
+    assert(!samples.empty());
+    for (const OrderingSample& s : samples) {
+      assert(s.best >= 0 && s.best < static_cast<int>(s.moves.size()));
+    }
+  }
+}
+
+int main() {
+  test_features();
+  test_fit();
+  test_solver_ordering();
+  return 0;
+}
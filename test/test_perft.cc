@@ -0,0 +1,64 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <iostream>
+#include "perft.h"
+
+// counts checked against an independent implementation of the same rules
+void test_perft_2x2() {
+  Go g(2);
+  long expected[] = {1, 5, 21, 68, 156, 316, 604, 1088, 2184, 4184, 8024,
+    13800, 23560};
+  for (int d = 0; d <= 12; d++) {
+    assert(perft(&g, BLACK, d) == expected[d]);
+  }
+}
+
+void test_perft_3x3() {
+  Go g(3);
+  long expected[] = {1, 10, 91, 738, 5281, 33384};
+  for (int d = 0; d <= 5; d++) {
+    assert(perft(&g, BLACK, d) == expected[d]);
+  }
+}
+
+void test_perft_4x4() {
+  Go g(4);
+  long expected[] = {1, 17, 273, 4112, 57984};
+  for (int d = 0; d <= 4; d++) {
+    assert(perft(&g, BLACK, d) == expected[d]);
+  }
+}
+
+void test_divide() {
+  Go g(3);
+  g.make_move(4, BLACK);
+  PerftResult r = perft_divide(&g, WHITE, 3);
+  long total = 0;
+  for (auto& d : r.divide) total += d.second;
+  assert(total == r.leaves);
+  // eight empty points and a pass
+  assert(r.divide.size() == 9);
+  assert(r.leaves == perft(&g, WHITE, 3));
+
+  // counting must leave the game untouched
+  assert(g.get_board().stones[BLACK] == 16);
+  assert(g.get_board().stones[WHITE] == 0);
+}
+
+void test_game_over() {
+  Go g(2);
+  g.make_move(PASS_IND, BLACK);
+  g.make_move(PASS_IND, WHITE);
+  assert(perft(&g, BLACK, 0) == 1);
+  assert(perft(&g, BLACK, 1) == 0);
+  assert(perft_divide(&g, BLACK, 2).leaves == 0);
+}
+
+int main() {
+  test_perft_2x2();
+  test_perft_3x3();
+  test_perft_4x4();
+  test_divide();
+  test_game_over();
+  return 0;
+}
@@ -0,0 +1,130 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "position_file.h"
+
+static const char *path = "bin/test/positions.pos";
+
+void test_round_trip() {
+  // the superko loop from test_batch, stopped just before the repeat
+  Go g(2);
+  assert(g.make_move(0, BLACK));
+  assert(g.make_move(3, WHITE));
+  assert(g.make_move(1, BLACK));
+  assert(g.make_move(2, WHITE));
+  assert(g.make_move(0, BLACK));
+  assert(g.make_move(1, WHITE));
+  Go passed(3);
+  assert(passed.make_move(PASS_IND, BLACK));
+
+  PositionWriter writer;
+  assert(writer.open(path, 8));
+  assert(writer.write(&g, BLACK));
+  assert(writer.write(&passed, WHITE));
+  assert(writer.close());
+  assert(writer.written() == 2);
+
+  PositionReader reader;
+  assert(reader.open(path));
+  assert(reader.size() == 2 && reader.history_slots() == 8);
+  const PositionRecord& r = reader[0];
+  assert(r.size == 2 && r.to_move == BLACK && r.passes == 0);
+  Board b(2);
+  assert(r.load(&b));
+  assert(b.stones[BLACK] == g.get_board().stones[BLACK]);
+  assert(b.stones[WHITE] == g.get_board().stones[WHITE]);
+  assert(b.h == g.get_board().h);
+
+  // the history still forbids repeating an earlier position
+  Go restored(3);
+  assert(r.setup(&restored));
+  assert(restored.size() == 2);
+  assert(!restored.make_move(0, BLACK));
+  assert(restored.rejected_by_superko());
+
+  // one more pass ends the game
+  assert(reader[1].size == 3 && reader[1].history_count == 0);
+  assert(reader[1].setup(&restored));
+  assert(restored.get_passes() == 1);
+  assert(restored.make_move(PASS_IND, WHITE));
+  assert(restored.game_over());
+}
+
+void test_history_slots() {
+  Go g(3);
+  assert(g.make_move(4, BLACK));
+  assert(g.make_move(0, WHITE));
+  assert(g.make_move(8, BLACK));
+  PositionWriter writer;
+  assert(writer.open(path, 1));
+  // two earlier positions don't fit in one slot
+  assert(!writer.write(&g, BLACK));
+  assert(writer.close() && writer.written() == 0);
+}
+
+void test_bad_files() {
+  PositionReader reader;
+  assert(!reader.open("bin/test/no_such_file.pos"));
+  {
+    std::ofstream out(path);
+    out << "3 .../.b./... w\n";
+  }
+  assert(!PositionReader::is_position_file(path));
+  assert(!reader.open(path));
+
+  // a header promising more records than the file holds
+  PositionWriter writer;
+  assert(writer.open(path, 0));
+  Go g(3);
+  assert(writer.write(&g, BLACK));
+  assert(writer.close());
+  assert(PositionReader::is_position_file(path));
+  std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+  f.seekp(offsetof(PositionHeader, count));
+  uint64_t count = 2;
+  f.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  f.close();
+  assert(!reader.open(path));
+}
+
+void test_convert() {
+  std::string script = "bin/test/script.txt";
+  std::string text = "bin/test/positions.txt";
+  {
+    std::ofstream out(script);
+    out << "boardsize 3\nplay b b2\nplay w a1 # corner\nshowboard\n";
+    out << "genmove b\nquit\n";
+  }
+  std::stringstream err;
+  assert(convert_positions({script}, path, DEFAULT_HISTORY_SLOTS, err) == 0);
+  assert(convert_positions({path}, text, 0, err) == 0);
+  std::ifstream in(text);
+  std::string line;
+  assert(std::getline(in, line));
+  assert(line == "3 w../.b./... b");
+  assert(!std::getline(in, line));
+
+  std::vector<BatchPosition> positions;
+  std::string error;
+  assert(read_position_file(path, &positions, &error));
+  assert(positions.size() == 1 && positions[0].superko.size() == 1);
+  std::stringstream out;
+  assert(run_batch(positions, out, 1) == 0);
+  assert(out.str().find("1 ") == 0);
+
+  assert(convert_positions({"bin/test/no_such_file.txt"}, path, 0, err) == 1);
+  std::remove(script.c_str());
+  std::remove(text.c_str());
+  std::remove(path);
+}
+
+int main() {
+  test_round_trip();
+  test_history_slots();
+  test_bad_files();
+  test_convert();
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "random_games.h"
+
+static const char *path = "bin/test/games.bin";
+static const char *other_path = "bin/test/games2.bin";
+
+// replay the game with Go, checking every move is legal
+static void check_game(const RandomGame& game, bool eye_aware) {
+  Go g(game.n);
+  Color c = BLACK;
+  for (int move : game.moves) {
+    if (eye_aware && move != PASS_IND) {
+      assert(!(g.get_board().eyes(c) & point_bit(move)));
+    }
+    assert(g.make_move(move, c));
+    c = Go::opponent(c);
+  }
+  assert(g.score(BLACK) == game.score);
+  assert(game.finished == g.game_over());
+  assert(game.finished ||
+      static_cast<int>(game.moves.size()) == RANDOM_GAME_MAX_MOVES(game.n));
+}
+
+void test_legal_games() {
+  Random rng(7);
+  RandomGame game;
+  for (int n = 2; n <= MAX_BOARD_SIZE; n++) {
+    for (int i = 0; i < 50; i++) {
+      play_random_game(n, false, &rng, &game);
+      check_game(game, false);
+      play_random_game(n, true, &rng, &game);
+      check_game(game, true);
+    }
+  }
+  // without filling their own eyes both sides eventually pass
+  play_random_game(5, true, &rng, &game);
+  assert(game.finished);
+}
+
+static std::string contents(const char *file) {
+  std::ifstream in(file, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(in)),
+      std::istreambuf_iterator<char>());
+}
+
+void test_file() {
+  // the games only depend on the seed, not on the threads playing them
+  long count = RANDOM_GAME_BLOCK + 100;
+  GeneratorResult r = generate_games(4, count, true, 1, 1, path);
+  assert(r.error.empty() && r.games == count && r.moves > count);
+  r = generate_games(4, count, true, 1, 3, other_path);
+  assert(r.error.empty());
+  assert(contents(path) == contents(other_path));
+
+  std::vector<RandomGame> games;
+  std::string error;
+  assert(read_game_file(path, &games, &error));
+  assert(static_cast<long>(games.size()) == count);
+  long moves = 0;
+  for (const RandomGame& game : games) {
+    check_game(game, true);
+    moves += game.moves.size();
+  }
+  assert(moves == r.moves);
+
+  r = generate_games(4, count, true, 2, 1, other_path);
+  assert(contents(path) != contents(other_path));
+
+  // a cut off file is rejected
+  std::string data = contents(path);
+  std::ofstream(other_path, std::ios::binary) << data.substr(0, 1000);
+  games.clear();
+  assert(!read_game_file(other_path, &games, &error));
+  assert(!error.empty());
+  std::remove(path);
+  std::remove(other_path);
+}
+
+int main() {
+  test_legal_games();
+  test_file();
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include "regions.h"
+#include "solver.h"
+
+Bitboard settled_both(const Board& b) {
+  return b.settled(BLACK) | b.settled(WHITE);
+}
+
+void test_find_regions() {
+  Board b(4);
+  assert(Board::from_string("wwb./bwww/..w./ww.w", 4, &b));
+  Bitboard settled = settled_both(b);
+  assert(settled == b.settled(WHITE));
+  Bitboard regions[MAX_POINTS];
+  int count = find_regions(b, settled, regions, MAX_POINTS);
+  assert(count == 2);
+  assert(!(regions[0] & regions[1]));
+  assert((regions[0] | regions[1]) == (b.size_mask & ~settled));
+  assert(!(b.adjacent(regions[0]) & regions[1]));
+  assert(find_regions(b, settled, regions, 1) == -1);
+
+  // nothing settled leaves the whole board as one region
+  Board empty(4);
+  assert(find_regions(empty, 0, regions, MAX_POINTS) == 1);
+  assert(regions[0] == empty.size_mask);
+}
+
+void test_local_values() {
+  const char *cold[] = {"wwb./bwww/..w./ww.w", "b.w./wwbw/bwb./.wwb",
+    "w.ww/.w.b/wwww/.w.."};
+  for (const char *position : cold) {
+    Board b(4);
+    assert(Board::from_string(position, 4, &b));
+    Bitboard black = b.settled(BLACK), white = b.settled(WHITE);
+    Bitboard regions[MAX_POINTS];
+    int count = find_regions(b, black | white, regions, MAX_POINTS);
+    assert(count > 1);
+    LocalSolver local;
+    float sum = bit_count(black) - bit_count(white);
+    for (int i = 0; i < count; i++) {
+      LocalValue v = local.solve(b, regions[i]);
+      assert(v.cold());
+      sum += v.black_first;
+    }
+    // the sum of the regions is what searching the whole board proves
+    for (Color c : {BLACK, WHITE}) {
+      Go g(b);
+      Solver s(false, 16);
+      s.set_decomposition(false);
+      s.solve(&g, c);
+      assert(s.get_result().value == (c == BLACK ? sum : -sum));
+    }
+  }
+
+  // the top two rows are worth more to whoever plays there first
+  Board b(4);
+  assert(Board::from_string(".bb./b.bb/wwww/..w.", 4, &b));
+  Bitboard regions[MAX_POINTS];
+  int count = find_regions(b, settled_both(b), regions, MAX_POINTS);
+  LocalSolver local;
+  bool hot = false;
+  for (int i = 0; i < count; i++) {
+    LocalValue v = local.solve(b, regions[i]);
+    if (v.solved && !v.cold()) hot = true;
+  }
+  assert(hot);
+}
+
+void test_solver_decomposition() {
+  const char *positions[] = {"wwb./bwww/..w./ww.w", "b.w./wwbw/bwb./.wwb",
+    ".bb./b.bb/wwww/..w.", ".wb./wwbb/b.bw/wwb."};
+  for (const char *position : positions) {
+    for (Color c : {BLACK, WHITE}) {
+      Board b(4);
+      assert(Board::from_string(position, 4, &b));
+      Go with_game(b), without_game(b);
+      Solver with(false, 16), without(false, 16);
+      without.set_decomposition(false);
+      with.solve(&with_game, c);
+      without.solve(&without_game, c);
+      assert(with.get_result().value == without.get_result().value);
+    }
+  }
+#ifndef NO_SEARCH_STATS
+  Board b(4);
+  assert(Board::from_string("wwb./bwww/..w./ww.w", 4, &b));
+  Go g(b);
+  Solver s(false, 16);
+  s.solve(&g, BLACK);
+  assert(s.get_stats().region_cutoffs > 0);
+#endif
+}
+
+int main() {
+  test_find_regions();
+  test_local_values();
+  test_solver_decomposition();
+  return 0;
+}
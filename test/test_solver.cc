@@ -0,0 +1,301 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "solver.h"
+
+void test_table_reuse() {
+  // a second solve of the same position starts from the stored results
+  Go g(3);
+  g.make_move(4, BLACK);
+  Solver s(false);
+  s.solve(&g, WHITE);
+  Result first = s.get_result();
+  long first_nodes = s.get_nodes();
+  assert(!first.is_undefined());
+
+  s.solve(&g, WHITE);
+  assert(s.get_result().value == first.value);
+  assert(s.get_nodes() < first_nodes);
+
+  // forgetting them makes it do all of the work again
+  s.clear();
+  s.solve(&g, WHITE);
+  assert(s.get_result().value == first.value);
+  assert(s.get_nodes() == first_nodes);
+}
+
+void test_table_after_reply() {
+  // results stored while searching one position are correct for the next
+  Go g(3);
+  Solver s(false);
+  s.solve(&g, BLACK);
+  assert(s.get_result().value == 9);
+  g.make_move(4, BLACK);
+  g.make_move(0, WHITE);
+  s.solve(&g, BLACK);
+  Solver fresh(false);
+  fresh.solve(&g, BLACK);
+  assert(s.get_result().value == fresh.get_result().value);
+  assert(s.get_nodes() <= fresh.get_nodes());
+}
+
+void test_table_history() {
+  // a stored root result doesn't hold once superko forbids its move
+  Board b(3);
+  assert(Board::from_string("bb./b.w/bbb", 3, &b));
+  Go g(b);
+  Solver s(false);
+  int move = s.solve(&g, BLACK);
+  Board next(b);
+  assert(next.move(move, BLACK));
+  g.add_history(next.h);
+  int again = s.solve(&g, BLACK);
+
+  Go fresh_game(b);
+  fresh_game.add_history(next.h);
+  Solver fresh(false);
+  assert(again != move);
+  assert(again == fresh.solve(&fresh_game, BLACK));
+  assert(s.get_result().value == fresh.get_result().value);
+}
+
+void test_follow_pv() {
+  // after both sides play the expected moves the next solve is cheap
+  Go g(2);
+  Solver s(false);
+  int move = s.solve(&g, BLACK);
+  long first_nodes = s.get_nodes();
+  Line pv = s.get_result().pv;
+  assert(pv.front() == move);
+  pv.pop_front();
+  g.make_move(move, BLACK);
+  g.make_move(pv.front(), WHITE);
+
+  s.solve(&g, BLACK);
+  Solver fresh(false);
+  fresh.solve(&g, BLACK);
+  assert(s.get_result().value == fresh.get_result().value);
+  assert(s.get_nodes() * 10 < first_nodes);
+#ifndef NO_SEARCH_STATS
+  // deepening started from what was already proven
+  assert(s.get_stats().iterations.size() <
+      fresh.get_stats().iterations.size());
+#endif
+}
+
+void test_safety_pruning() {
+  // the same values with and without the score bounds of safe stones
+  const char *positions[] = {"b../.../...", ".b./.wb/w..", "b.w/bww/bb."};
+  long nodes_with = 0, nodes_without = 0;
+  for (const char *position : positions) {
+    for (Color c : {BLACK, WHITE}) {
+      Board b(3);
+      assert(Board::from_string(position, 3, &b));
+      Go g(b);
+      Solver with(false), without(false);
+      without.set_safety_pruning(false);
+      with.solve(&g, c);
+      without.solve(&g, c);
+      assert(with.get_result().value == without.get_result().value);
+      nodes_with += with.get_nodes();
+      nodes_without += without.get_nodes();
+    }
+  }
+  assert(nodes_with < nodes_without);
+
+  // white can't play on this board at all, so black owns all of it, and
+  // passing is the only legal move
+  Board b(2);
+  assert(Board::from_string("b./.b", 2, &b));
+  Go g(b);
+  Solver s(false);
+  assert(s.solve(&g, WHITE) == PASS_IND);
+  assert(s.get_result().value == -4);
+}
+
+void test_root_move() {
+  // a theorem decides this board, the root still has to find the center
+  Board b(3);
+  assert(Board::from_string(".../.../b..", 3, &b));
+  Go g(b);
+  Solver s(false);
+  assert(s.solve(&g, WHITE) == 4);
+  assert(s.get_result().value == 9);
+}
+
+void test_pvs() {
+  // null window searches prove the same values as full windows
+  const char *positions[] = {".b./.wb/w..", "b../bw./bbb", "b../..w/...",
+    ".../.../...", ".../.b./..."};
+  for (const char *position : positions) {
+    for (Color c : {BLACK, WHITE}) {
+      Board b(3);
+      assert(Board::from_string(position, 3, &b));
+      Go g(b);
+      Solver with(false), without(false);
+      without.set_pvs(false);
+      with.solve(&g, c);
+      without.solve(&g, c);
+      assert(with.get_result().value == without.get_result().value);
+    }
+  }
+  // moves that turn out better than the first are searched again
+  Board b(3);
+  assert(Board::from_string(".b./.wb/w..", 3, &b));
+  Go g(b);
+  Solver s(false);
+  s.solve(&g, BLACK);
+  assert(s.get_result().value == 1);
+#ifndef NO_SEARCH_STATS
+  assert(s.get_stats().pvs_researches > 0);
+#endif
+}
+
+void test_etc() {
+  // a stored refutation of one move proves the same value as searching it
+  const char *positions[] = {".b./.wb/w..", "b../..w/...", ".../.b./..."};
+  for (const char *position : positions) {
+    for (Color c : {BLACK, WHITE}) {
+      Board b(3);
+      assert(Board::from_string(position, 3, &b));
+      Go g(b);
+      Solver with(false), without(false);
+      without.set_etc(false);
+      with.solve(&g, c);
+      without.solve(&g, c);
+      assert(with.get_result().value == without.get_result().value);
+    }
+  }
+#ifndef NO_SEARCH_STATS
+  Board b(3);
+  assert(Board::from_string(".b./.wb/w..", 3, &b));
+  Go g(b);
+  Solver s(false);
+  s.solve(&g, BLACK);
+  assert(s.get_stats().etc_cutoffs > 0);
+#endif
+}
+
+// a stringstream that lets another thread wait for the first complete line
+class FirstLine : public std::stringbuf {
+ public:
+  // false if no line came within the timeout
+  bool wait(std::chrono::seconds timeout) {
+    std::unique_lock<std::mutex> guard(lock);
+    return written.wait_for(guard, timeout, [this]() { return lines > 0; });
+  }
+
+ protected:
+  // std::endl flushes
+  int sync() override {
+    std::lock_guard<std::mutex> guard(lock);
+    lines++;
+    written.notify_all();
+    return 0;
+  }
+
+ private:
+  std::mutex lock;
+  std::condition_variable written;
+  int lines = 0;
+};
+
+void test_stop() {
+  Go g(3);
+  Solver s(false);
+  s.stop();
+  s.solve(&g, BLACK);
+  assert(s.get_result().is_undefined());
+  s.clear_stop();
+  assert(s.solve(&g, BLACK) == 4);
+
+  // 4x4 is out of reach, stopping it after the first iteration still gives
+  // a legal move, the timeouts only guard against hangs
+  Go big(4);
+  Solver t(false);
+  FirstLine lines;
+  std::ostream info(&lines);
+  t.set_info(&info);
+  std::future<int> search = std::async(std::launch::async,
+      [&]() { return t.solve(&big, BLACK); });
+  assert(lines.wait(std::chrono::seconds(30)));
+  t.stop();
+  assert(search.wait_for(std::chrono::seconds(30)) ==
+      std::future_status::ready);
+  int move = search.get();
+  assert(t.get_result().is_undefined());
+  assert(move != UNDEFINED && big.make_move(move, BLACK));
+  // one line per iteration and progress in between
+  assert(lines.str().find("info depth 1 nodes ") == 0);
+  assert(lines.str().find(" nps ") != std::string::npos);
+}
+
+struct Solved {
+  int move;
+  float value;
+  long nodes;
+};
+
+static Solved solve_position(const char *position, int n, Color c) {
+  Board b(n);
+  assert(Board::from_string(position, n, &b));
+  Go g(b);
+  Solver s(false, 12);
+  int move = s.solve(&g, c);
+  return {move, s.get_result().value, s.get_nodes()};
+}
+
+void test_concurrent_games() {
+  // many games and solvers in one process don't share any state, every
+  // thread gets exactly the result of solving on its own
+  const char *positions[] = {"b../bw./bbb", "b../..w/...", ".../.b./...",
+    "b./..", "../.."};
+  const int count = sizeof(positions) / sizeof(positions[0]);
+  std::vector<Solved> expected;
+  for (int i = 0; i < 2 * count; i++) {
+    const char *p = positions[i / 2];
+    expected.push_back(solve_position(p, p[2] == '/' ? 2 : 3,
+        static_cast<Color>(i % 2)));
+  }
+
+  const int threads = 200;
+  std::vector<Solved> results(threads);
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; t++) {
+    pool.emplace_back([&, t]() {
+      int i = t % (2 * count);
+      const char *p = positions[i / 2];
+      results[t] = solve_position(p, p[2] == '/' ? 2 : 3,
+          static_cast<Color>(i % 2));
+    });
+  }
+  for (auto& t : pool) t.join();
+
+  for (int t = 0; t < threads; t++) {
+    const Solved& e = expected[t % (2 * count)];
+    assert(results[t].move == e.move);
+    assert(results[t].value == e.value);
+    assert(results[t].nodes == e.nodes);
+  }
+}
+
+int main() {
+  test_table_reuse();
+  test_table_after_reply();
+  test_table_history();
+  test_follow_pv();
+  test_safety_pruning();
+  test_root_move();
+  test_pvs();
+  test_etc();
+  test_stop();
+  test_concurrent_games();
+  return 0;
+}
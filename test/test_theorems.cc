@@ -0,0 +1,57 @@
+// Copyright 2019 Chris Solinas
+#include <cassert>
+#include <memory>
+#include <vector>
+#include "theorems.h"
+
+void test_table_matches_theorems() {
+  std::vector<std::unique_ptr<Theorem>> theorems;
+  theorems.emplace_back(new Middle3x3());
+  theorems.emplace_back(new Corner3x3());
+  theorems.emplace_back(new SideOnly3x3());
+  theorems.emplace_back(new SideSingle3x3());
+  theorems.emplace_back(new SideDouble3x3());
+  theorems.emplace_back(new CornerSingle3x3());
+  const TheoremTable3x3& table = TheoremTable3x3::get();
+  assert(table.size() == static_cast<int>(theorems.size()));
+
+  // every legal and illegal arrangement of stones
+  int hits = 0;
+  for (int black = 0; black < 512; black++) {
+    for (int white = 0; white < 512; white++) {
+      if (black & white) continue;
+      Board b(3);
+      b.set_stones(black, white);
+      for (Color c : {BLACK, WHITE}) {
+        int expected = -1;
+        for (size_t t = 0; t < theorems.size(); t++) {
+          if (theorems[t]->applies(b, c)) {
+            expected = t;
+            break;
+          }
+        }
+        assert(table.lookup(b, c) == expected);
+        if (expected >= 0) {
+          assert(table.value(expected) == theorems[expected]->get_value());
+          hits++;
+        }
+      }
+    }
+  }
+  assert(hits > 0);
+}
+
+void test_keys() {
+  Board b(3);
+  assert(TheoremTable3x3::key(b) == 0);
+  b.set_stones(1, 2);
+  assert(TheoremTable3x3::key(b) == 1 + 2 * 3);
+  b.set_stones(0, 256);
+  assert(TheoremTable3x3::key(b) == 2 * 6561);
+}
+
+int main() {
+  test_table_matches_theorems();
+  test_keys();
+  return 0;
+}